@@ -0,0 +1,180 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace jb::bench
+{
+
+/** Prevents the compiler from optimising away the computation of the value pointed to */
+template <typename T>
+inline void doNotOptimise (T* value)
+{
+   #if defined (__GNUC__) || defined (__clang__)
+    asm volatile ("" : : "r" (value) : "memory");
+   #else
+    static volatile const void* sink;
+    sink = value;
+   #endif
+}
+
+/** The result of a single benchmark run */
+struct Measurement
+{
+    std::string suite;
+    std::string name;
+
+    /** Parameters the benchmark ran with, e.g. { "channels", 16 } */
+    std::vector<std::pair<std::string, double>> parameters;
+
+    /** Median time of one call to the benchmarked function */
+    double nanosecondsPerIteration = 0.0;
+
+    /** Median throughput, where an item is whatever the benchmark counts, e.g. samples */
+    double itemsPerSecond = 0.0;
+};
+
+/** Collects the measurements of all benchmarks and prints them */
+class Reporter
+{
+public:
+    void add (Measurement m)
+    {
+        measurements.push_back (std::move (m));
+    }
+
+    const std::vector<Measurement>& getMeasurements() const { return measurements; }
+
+    void printTable() const
+    {
+        for (const auto& m : measurements)
+        {
+            std::string params;
+
+            for (const auto& [key, value] : m.parameters)
+                params += key + "=" + std::to_string (static_cast<long long> (value)) + " ";
+
+            std::printf ("%-14s %-28s %-40s %12.1f ns %10.2f Mitems/s\n",
+                         m.suite.c_str(), m.name.c_str(), params.c_str(), m.nanosecondsPerIteration, m.itemsPerSecond * 1e-6);
+        }
+    }
+
+    /** Writes all measurements as json, so that results of different builds can be compared by scripts */
+    bool writeJson (const std::string& path) const
+    {
+        auto benchmarks = nlohmann::json::array();
+
+        for (const auto& m : measurements)
+        {
+            auto parameters = nlohmann::json::object();
+
+            for (const auto& [key, value] : m.parameters)
+                parameters[key] = value;
+
+            benchmarks.push_back ({ { "suite",                   m.suite },
+                                    { "name",                    m.name },
+                                    { "parameters",              parameters },
+                                    { "nanosecondsPerIteration", m.nanosecondsPerIteration },
+                                    { "itemsPerSecond",          m.itemsPerSecond } });
+        }
+
+        std::ofstream file (path);
+        file << nlohmann::json { { "benchmarks", benchmarks } }.dump (2) << '\n';
+
+        return file.good();
+    }
+
+private:
+    std::vector<Measurement> measurements;
+};
+
+/**
+ * Runs fn repeatedly in batches for roughly the given time after a short warm up and returns the median batch timing.
+ * itemsPerIteration is used to compute the throughput.
+ */
+template <typename Fn>
+Measurement measure (std::string suite,
+                     std::string name,
+                     std::vector<std::pair<std::string, double>> parameters,
+                     double itemsPerIteration,
+                     Fn&& fn,
+                     std::chrono::milliseconds targetTime = std::chrono::milliseconds (200))
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up and find a batch size that takes about a millisecond
+    int batchSize = 1;
+    for (;;)
+    {
+        const auto start = Clock::now();
+
+        for (int i = 0; i < batchSize; ++i)
+            fn();
+
+        if (Clock::now() - start > std::chrono::milliseconds (1) || batchSize > (1 << 24))
+            break;
+
+        batchSize *= 2;
+    }
+
+    std::vector<double> nsPerIteration;
+    const auto end = Clock::now() + targetTime;
+
+    while (Clock::now() < end || nsPerIteration.size() < 5)
+    {
+        const auto start = Clock::now();
+
+        for (int i = 0; i < batchSize; ++i)
+            fn();
+
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        nsPerIteration.push_back (elapsed.count() / batchSize);
+    }
+
+    std::nth_element (nsPerIteration.begin(), nsPerIteration.begin() + static_cast<std::ptrdiff_t> (nsPerIteration.size() / 2), nsPerIteration.end());
+
+    Measurement m;
+    m.suite                   = std::move (suite);
+    m.name                    = std::move (name);
+    m.parameters              = std::move (parameters);
+    m.nanosecondsPerIteration = nsPerIteration[nsPerIteration.size() / 2];
+    m.itemsPerSecond          = itemsPerIteration * 1e9 / m.nanosecondsPerIteration;
+    return m;
+}
+
+void runDelayLineBenchmarks (Reporter& reporter);
+void runBypassBenchmarks (Reporter& reporter);
+void runStateBenchmarks (Reporter& reporter);
+
+}
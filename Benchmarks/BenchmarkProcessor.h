@@ -0,0 +1,89 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+namespace jb::bench
+{
+
+/** A ParameterProvider with numParameters float parameters and a bypass parameter */
+template <int numParameters>
+struct BenchmarkParameters
+{
+    struct Bypass
+    {
+        static inline const juce::String id = "bypass";
+    };
+
+    static juce::String getParameterId (int index)
+    {
+        return "param" + juce::String (index);
+    }
+
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
+    {
+        juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+        for (int i = 0; i < numParameters; ++i)
+            layout.add (std::make_unique<juce::AudioParameterFloat> (getParameterId (i), "Parameter " + juce::String (i), 0.0f, 1.0f, 0.5f));
+
+        layout.add (std::make_unique<juce::AudioParameterBool> (Bypass::id, "Bypass", false));
+
+        return layout;
+    }
+
+    static juce::StringArray getPresetManagerParameters()
+    {
+        juce::StringArray ids;
+
+        for (int i = 0; i < numParameters; ++i)
+            ids.add (getParameterId (i));
+
+        return ids;
+    }
+};
+
+JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Woverloaded-virtual")
+
+/** A minimal processor on top of PluginAudioProcessorBase that applies a gain, so that the base's overhead dominates */
+template <int numParameters>
+class BenchmarkProcessor : public PluginAudioProcessorBase<BenchmarkParameters<numParameters>>
+{
+public:
+    void prepareResources (bool, bool, bool) override {}
+
+    void processBlock (juce::dsp::AudioBlock<float>& block) override
+    {
+        block.multiplyBy (0.5f);
+    }
+
+    juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+    bool hasEditor() const override                     { return false; }
+};
+
+JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+
+}
@@ -0,0 +1,134 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "Benchmark.h"
+#include "BenchmarkProcessor.h"
+
+namespace jb::bench
+{
+
+namespace
+{
+    constexpr int blockSize = 256;
+
+    const char* getShapeName (CrossfadeShape shape)
+    {
+        switch (shape)
+        {
+            case CrossfadeShape::linear:     return "linear";
+            case CrossfadeShape::equalPower: return "equalPower";
+            case CrossfadeShape::sCurve:     return "sCurve";
+        }
+
+        return "";
+    }
+
+    /** The crossfade kernel alone, fading one block of each channel */
+    void runCrossfadeKernelBenchmarks (Reporter& reporter)
+    {
+        for (auto shape : { CrossfadeShape::linear, CrossfadeShape::equalPower, CrossfadeShape::sCurve })
+        {
+            CrossfadeTable<float> table (blockSize, shape);
+
+            for (auto channels : { 1, 2, 8 })
+            {
+                juce::AudioBuffer<float> wet (channels, blockSize);
+                juce::AudioBuffer<float> dry (channels, blockSize);
+                juce::AudioBuffer<float> dst (channels, blockSize);
+
+                for (int c = 0; c < channels; ++c)
+                {
+                    juce::FloatVectorOperations::fill (wet.getWritePointer (c), 1.0f, blockSize);
+                    juce::FloatVectorOperations::fill (dry.getWritePointer (c), -1.0f, blockSize);
+                }
+
+                reporter.add (measure ("Crossfade", std::string ("kernel ") + getShapeName (shape),
+                                       { { "channels", channels }, { "blockSize", blockSize } },
+                                       static_cast<double> (channels * blockSize),
+                                       [&]
+                                       {
+                                           for (int c = 0; c < channels; ++c)
+                                               table.crossfade (dst.getWritePointer (c), wet.getReadPointer (c), dry.getReadPointer (c), 0, blockSize);
+
+                                           doNotOptimise (dst.getWritePointer (0));
+                                       }));
+            }
+        }
+    }
+
+    /**
+     * The whole bypass path of PluginAudioProcessorBase with latency compensation, once while processing and once with
+     * the bypass parameter toggled before every block, so that every block contains a fade
+     */
+    void runBypassPathBenchmarks (Reporter& reporter)
+    {
+        for (auto channels : { 1, 2, 8 })
+        {
+            for (auto toggleBypass : { false, true })
+            {
+                BenchmarkProcessor<0> processor;
+                auto& audioProcessor = static_cast<juce::AudioProcessor&> (processor);
+
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses .add (juce::AudioChannelSet::canonicalChannelSet (channels));
+                layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (channels));
+                audioProcessor.setBusesLayout (layout);
+
+                processor.setMaximumLatencySamples (blockSize);
+                processor.setLatencySamples (64);
+                audioProcessor.prepareToPlay (48000.0, blockSize);
+
+                juce::AudioBuffer<float> buffer (channels, blockSize);
+                juce::MidiBuffer midi;
+                auto* bypass = audioProcessor.getBypassParameter();
+                bool bypassed = false;
+
+                reporter.add (measure ("Bypass", toggleBypass ? "processBlock fading" : "processBlock processing",
+                                       { { "channels", channels }, { "blockSize", blockSize }, { "latency", 64 } },
+                                       static_cast<double> (channels * blockSize),
+                                       [&]
+                                       {
+                                           if (toggleBypass)
+                                           {
+                                               bypassed = ! bypassed;
+                                               bypass->setValueNotifyingHost (bypassed ? 1.0f : 0.0f);
+                                           }
+
+                                           audioProcessor.processBlock (buffer, midi);
+                                           doNotOptimise (buffer.getWritePointer (0));
+                                       }));
+
+                audioProcessor.releaseResources();
+            }
+        }
+    }
+}
+
+void runBypassBenchmarks (Reporter& reporter)
+{
+    runCrossfadeKernelBenchmarks (reporter);
+    runBypassPathBenchmarks (reporter);
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+#include "Benchmark.h"
+
+namespace jb::bench
+{
+
+namespace
+{
+    constexpr int blockSize = 256;
+
+    template <class DelayLineType>
+    Measurement measureDelayLine (const char* name, int delayLength, int numChannels)
+    {
+        DelayLineType delayLine (delayLength, numChannels);
+
+        juce::AudioBuffer<float> src  (numChannels, blockSize);
+        juce::AudioBuffer<float> dest (numChannels, blockSize);
+
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < blockSize; ++i)
+                src.setSample (c, i, static_cast<float> (i + c));
+
+        juce::dsp::AudioBlock<float> srcBlock (src);
+        juce::dsp::AudioBlock<float> destBlock (dest);
+
+        return measure ("DelayLine", name,
+                        { { "channels", numChannels }, { "length", delayLength }, { "blockSize", blockSize } },
+                        static_cast<double> (numChannels * blockSize),
+                        [&]
+                        {
+                            delayLine.processBlock (srcBlock, destBlock);
+                            doNotOptimise (dest.getWritePointer (0));
+                        });
+    }
+
+    /** Compares the storage policies and prints the fastest one per configuration to find the crossover point */
+    void runStoragePolicyComparison (Reporter& reporter)
+    {
+        std::printf ("\nMultichannelDelayLine storage policies, fastest layout per configuration:\n");
+
+        for (auto length : { 64, 4096, 48000 })
+        {
+            for (auto channels : { 2, 4, 8, 16, 32, 64 })
+            {
+                const Measurement results[] =
+                {
+                    measureDelayLine<MultichannelDelayLine<float>>                                   ("Planar",         length, channels),
+                    measureDelayLine<MultichannelDelayLine<float, DelayLineStorage::Interleaved>>    ("Interleaved",    length, channels),
+                    measureDelayLine<MultichannelDelayLine<float, DelayLineStorage::LaneGrouped<4>>> ("LaneGrouped<4>", length, channels),
+                    measureDelayLine<MultichannelDelayLine<float, DelayLineStorage::LaneGrouped<8>>> ("LaneGrouped<8>", length, channels)
+                };
+
+                const auto& fastest = *std::min_element (std::begin (results), std::end (results), [] (auto& a, auto& b)
+                {
+                    return a.nanosecondsPerIteration < b.nanosecondsPerIteration;
+                });
+
+                std::printf ("  length %6d, %2d channels: %s\n", length, channels, fastest.name.c_str());
+
+                for (const auto& r : results)
+                    reporter.add (r);
+            }
+        }
+    }
+}
+
+void runDelayLineBenchmarks (Reporter& reporter)
+{
+    runStoragePolicyComparison (reporter);
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+#include "Benchmark.h"
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args (argc, argv);
+
+    // The presets and settings written by the benchmarks go to a temporary directory, which is removed afterwards, so
+    // that no state is left behind in the user application data directory
+    const auto dataDirectory = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                                   .getNonexistentChildFile ("jb_plugin_base_bench", {}, false);
+
+    jb::StateAndPresetManager::setPresetDirectoryForTesting (dataDirectory);
+
+    jb::bench::Reporter reporter;
+
+    jb::bench::runDelayLineBenchmarks (reporter);
+    jb::bench::runBypassBenchmarks (reporter);
+    jb::bench::runStateBenchmarks (reporter);
+
+   #if JB_INCLUDE_JSON
+    // Writes the settings file, so this has to happen before the directory is removed
+    jb::SettingsManager::deleteInstance();
+   #endif
+
+    dataDirectory.deleteRecursively();
+
+    std::printf ("\n");
+    reporter.printTable();
+
+    // Pass --json <file> to write the results in a machine readable format, e.g. to track them over time in CI
+    if (args.containsOption ("--json"))
+    {
+        const auto path = args.getValueForOption ("--json").toStdString();
+
+        if (path.empty() || ! reporter.writeJson (path))
+        {
+            std::fprintf (stderr, "Could not write the results to %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
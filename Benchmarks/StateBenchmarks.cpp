@@ -0,0 +1,138 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "Benchmark.h"
+#include "BenchmarkProcessor.h"
+
+namespace jb::bench
+{
+
+namespace
+{
+    template <int numParameters>
+    void measureStateInformation (Reporter& reporter)
+    {
+        BenchmarkProcessor<numParameters> processor;
+        auto& audioProcessor = static_cast<juce::AudioProcessor&> (processor);
+
+        juce::MemoryBlock state;
+
+        reporter.add (measure ("State", "getStateInformation", { { "parameters", numParameters } }, 1.0, [&]
+        {
+            state.reset();
+            audioProcessor.getStateInformation (state);
+            doNotOptimise (state.getData());
+        }));
+
+        reporter.add (measure ("State", "setStateInformation", { { "parameters", numParameters } }, 1.0, [&]
+        {
+            audioProcessor.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        }));
+    }
+
+    /**
+     * Each StateAndPresetManager scans the preset directory when it is created, so this measures creating a processor
+     * with a number of preset files in the directory. The files are created in the preset directory, which the benchmark
+     * app points to a temporary directory, and removed afterwards.
+     */
+    void runPresetScanBenchmarks (Reporter& reporter)
+    {
+        const auto& directory = StateAndPresetManager::presetDirectory;
+        directory.createDirectory();
+
+        juce::Array<juce::File> createdFiles;
+
+        for (auto numPresets : { 0, 100, 10000 })
+        {
+            while (createdFiles.size() < numPresets)
+            {
+                auto file = directory.getChildFile ("jb_bench_preset_" + juce::String (createdFiles.size()) + ".xml");
+                file.create();
+                createdFiles.add (file);
+            }
+
+            reporter.add (measure ("Presets", "scan on construction", { { "presets", numPresets } }, 1.0, []
+            {
+                BenchmarkProcessor<10> processor;
+                doNotOptimise (&processor);
+            }));
+        }
+
+        for (auto& f : createdFiles)
+            f.deleteFile();
+    }
+
+   #if JB_INCLUDE_JSON
+    void runSettingsBenchmarks (Reporter& reporter)
+    {
+        auto* settings = SettingsManager::getInstance();
+
+        for (auto numSettings : { 10, 1000 })
+        {
+            for (int i = 0; i < numSettings; ++i)
+            {
+                settings->writeSetting ("jbBenchDouble" + juce::String (i), static_cast<double> (i));
+                settings->writeSetting ("jbBenchString" + juce::String (i), juce::String (i));
+            }
+
+            const juce::String doubleId ("jbBenchDouble" + juce::String (numSettings / 2));
+            const juce::String stringId ("jbBenchString" + juce::String (numSettings / 2));
+
+            reporter.add (measure ("Settings", "getDoubleSetting", { { "settings", numSettings } }, 1.0, [&]
+            {
+                auto value = settings->getDoubleSetting (doubleId, 0.0);
+                doNotOptimise (&value);
+            }));
+
+            reporter.add (measure ("Settings", "getStringSetting", { { "settings", numSettings } }, 1.0, [&]
+            {
+                auto value = settings->getStringSetting (stringId, {});
+                doNotOptimise (&value);
+            }));
+
+            reporter.add (measure ("Settings", "settingExists missing", { { "settings", numSettings } }, 1.0, [&]
+            {
+                auto exists = settings->settingExists ("jbBenchMissing");
+                doNotOptimise (&exists);
+            }));
+        }
+    }
+   #endif
+}
+
+void runStateBenchmarks (Reporter& reporter)
+{
+    measureStateInformation<10> (reporter);
+    measureStateInformation<100> (reporter);
+    measureStateInformation<1000> (reporter);
+    measureStateInformation<5000> (reporter);
+
+    runPresetScanBenchmarks (reporter);
+
+   #if JB_INCLUDE_JSON
+    runSettingsBenchmarks (reporter);
+   #endif
+}
+
+}
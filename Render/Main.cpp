@@ -0,0 +1,439 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+ #include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+/** Implemented by the plugin the harness is linked against */
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace jb::render
+{
+
+namespace
+{
+    struct Options
+    {
+        juce::File       inputFile;
+        juce::File       outputFile;
+        juce::File       automationFile;
+        juce::File       jsonFile;
+        std::vector<int> blockSizes { 512 };
+        int              numChannels = 0;
+        int              numPasses   = 1;
+    };
+
+    /** A line "<time in seconds> <parameter id> <normalised value>" of the automation script */
+    struct AutomationPoint
+    {
+        double                         timeSeconds;
+        juce::AudioProcessorParameter* parameter;
+        float                          normalisedValue;
+    };
+
+    struct PassResult
+    {
+        int    blockSize;
+        int    pass;
+        double audioSeconds;
+        double processSeconds;
+
+        /** Processing time of a single block */
+        double p50Microseconds;
+        double p99Microseconds;
+        double maxMicroseconds;
+    };
+
+    void printUsage()
+    {
+        std::printf ("Renders a wav file through the plugin offline and reports its processing speed\n\n"
+                     "Options:\n"
+                     "  --input <file>        The wav file to process, required\n"
+                     "  --output <file>       Writes the output of the first pass to this wav file\n"
+                     "  --block-size <n,...>  Comma separated list of block sizes to run a pass with each, default 512\n"
+                     "  --channels <n>        Number of main bus channels, defaults to the channels of the input file\n"
+                     "  --passes <n>          Number of passes per block size, default 1\n"
+                     "  --automation <file>   Automation script, each line holds \"<seconds> <parameter id> <normalised value>\"\n"
+                     "  --json <file>         Writes the results to this json file\n");
+    }
+
+    bool parseOptions (const juce::ArgumentList& args, Options& options)
+    {
+        if (! args.containsOption ("--input"))
+            return false;
+
+        options.inputFile = args.getExistingFileForOption ("--input");
+
+        if (args.containsOption ("--output"))
+            options.outputFile = args.getFileForOption ("--output");
+
+        if (args.containsOption ("--automation"))
+            options.automationFile = args.getExistingFileForOption ("--automation");
+
+        if (args.containsOption ("--json"))
+            options.jsonFile = args.getFileForOption ("--json");
+
+        if (args.containsOption ("--block-size"))
+        {
+            options.blockSizes.clear();
+
+            for (auto& s : juce::StringArray::fromTokens (args.getValueForOption ("--block-size"), ",", ""))
+                options.blockSizes.push_back (s.getIntValue());
+
+            if (options.blockSizes.empty() || std::any_of (options.blockSizes.begin(), options.blockSizes.end(), [] (int b) { return b <= 0; }))
+                return false;
+        }
+
+        if (args.containsOption ("--channels"))
+            options.numChannels = args.getValueForOption ("--channels").getIntValue();
+
+        if (args.containsOption ("--passes"))
+            options.numPasses = args.getValueForOption ("--passes").getIntValue();
+
+        return options.numChannels >= 0 && options.numPasses > 0;
+    }
+
+    juce::Result loadAutomation (const juce::File& file, juce::AudioProcessor& processor, std::vector<AutomationPoint>& points)
+    {
+        std::map<juce::String, juce::AudioProcessorParameter*> parametersById;
+
+        for (auto* p : processor.getParameters())
+            if (auto* withId = dynamic_cast<juce::AudioProcessorParameterWithID*> (p))
+                parametersById[withId->paramID] = p;
+
+        const auto lines = juce::StringArray::fromLines (file.loadFileAsString());
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            const auto line = lines[i].upToFirstOccurrenceOf ("#", false, false).trim();
+
+            if (line.isEmpty())
+                continue;
+
+            const auto tokens = juce::StringArray::fromTokens (line, true);
+            const auto lineNumber = juce::String (i + 1);
+
+            if (tokens.size() != 3)
+                return juce::Result::fail ("Automation line " + lineNumber + " does not have the form <seconds> <parameter id> <value>");
+
+            const auto parameter = parametersById.find (tokens[1]);
+
+            if (parameter == parametersById.end())
+                return juce::Result::fail ("Automation line " + lineNumber + " refers to the unknown parameter " + tokens[1]);
+
+            points.push_back ({ tokens[0].getDoubleValue(), parameter->second, juce::jlimit (0.0f, 1.0f, tokens[2].getFloatValue()) });
+        }
+
+        std::stable_sort (points.begin(), points.end(), [] (auto& a, auto& b) { return a.timeSeconds < b.timeSeconds; });
+
+        return juce::Result::ok();
+    }
+
+    juce::Result setMainBusChannels (juce::AudioProcessor& processor, int numChannels)
+    {
+        auto layout = processor.getBusesLayout();
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        if (! layout.inputBuses.isEmpty())
+            layout.inputBuses.getReference (0) = channelSet;
+
+        if (! layout.outputBuses.isEmpty())
+            layout.outputBuses.getReference (0) = channelSet;
+
+        if (! processor.setBusesLayout (layout))
+            return juce::Result::fail ("The plugin does not support " + juce::String (numChannels) + " channels on its main buses");
+
+        return juce::Result::ok();
+    }
+
+    double getPercentile (std::vector<double>& values, double percentile)
+    {
+        const auto index = std::min (values.size() - 1, static_cast<size_t> (percentile * static_cast<double> (values.size())));
+        std::nth_element (values.begin(), values.begin() + static_cast<std::ptrdiff_t> (index), values.end());
+        return values[index];
+    }
+
+    /** Returns the peak resident set size of the process in bytes or -1 if it is not available on this platform */
+    juce::int64 getPeakResidentSetBytes()
+    {
+       #if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+        rusage usage {};
+
+        if (getrusage (RUSAGE_SELF, &usage) != 0)
+            return -1;
+
+        // ru_maxrss is reported in kilobytes on Linux and the BSDs but in bytes on macOS
+       #if JUCE_MAC
+        return static_cast<juce::int64> (usage.ru_maxrss);
+       #else
+        return static_cast<juce::int64> (usage.ru_maxrss) * 1024;
+       #endif
+       #else
+        return -1;
+       #endif
+    }
+
+    /**
+     * Streams the whole file through the processor. Automation points are applied before the block that contains their
+     * time, so their resolution is the block size. Only the processBlock calls are timed, not reading and writing.
+     */
+    PassResult runPass (juce::AudioProcessor& processor,
+                        juce::AudioFormatReader& reader,
+                        int blockSize,
+                        int pass,
+                        const std::vector<AutomationPoint>& automation,
+                        juce::AudioFormatWriter* writer)
+    {
+        const auto sampleRate = reader.sampleRate;
+        const auto numInputChannels = processor.getTotalNumInputChannels();
+        const auto numFileChannels = static_cast<int> (reader.numChannels);
+
+        // Lets processors that switch quality or skip realtime only paths in offline mode behave like in an export
+        processor.setNonRealtime (true);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer (std::max (numInputChannels, processor.getTotalNumOutputChannels()), blockSize);
+        juce::AudioBuffer<float> fileBuffer (numFileChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        std::vector<double> blockSeconds;
+        blockSeconds.reserve (static_cast<size_t> (reader.lengthInSamples / blockSize + 1));
+
+        size_t nextAutomationPoint = 0;
+        juce::int64 totalTicks = 0;
+
+        for (juce::int64 position = 0; position < reader.lengthInSamples; position += blockSize)
+        {
+            const auto numSamples = static_cast<int> (std::min (static_cast<juce::int64> (blockSize), reader.lengthInSamples - position));
+
+            buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+            buffer.clear();
+
+            reader.read (&fileBuffer, 0, numSamples, position, true, true);
+
+            // Files with fewer channels than the plugin are repeated across its input channels
+            if (numFileChannels > 0)
+                for (int c = 0; c < numInputChannels; ++c)
+                    buffer.copyFrom (c, 0, fileBuffer, c % numFileChannels, 0, numSamples);
+
+            for (; nextAutomationPoint < automation.size() && automation[nextAutomationPoint].timeSeconds * sampleRate < double (position + numSamples); ++nextAutomationPoint)
+                automation[nextAutomationPoint].parameter->setValueNotifyingHost (automation[nextAutomationPoint].normalisedValue);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            const auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+            totalTicks += ticks;
+            blockSeconds.push_back (juce::Time::highResolutionTicksToSeconds (ticks));
+            midi.clear();
+
+            if (writer != nullptr)
+                writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+        }
+
+        processor.releaseResources();
+
+        PassResult result;
+        result.blockSize       = blockSize;
+        result.pass            = pass;
+        result.audioSeconds    = static_cast<double> (reader.lengthInSamples) / sampleRate;
+        result.processSeconds  = juce::Time::highResolutionTicksToSeconds (totalTicks);
+        result.p50Microseconds = blockSeconds.empty() ? 0.0 : getPercentile (blockSeconds, 0.5) * 1e6;
+        result.p99Microseconds = blockSeconds.empty() ? 0.0 : getPercentile (blockSeconds, 0.99) * 1e6;
+        result.maxMicroseconds = blockSeconds.empty() ? 0.0 : *std::max_element (blockSeconds.begin(), blockSeconds.end()) * 1e6;
+        return result;
+    }
+
+    juce::var toJson (const Options& options, const juce::AudioProcessor& processor, double sampleRate, const std::vector<PassResult>& results)
+    {
+        juce::Array<juce::var> passes;
+
+        for (auto& r : results)
+        {
+            auto* pass = new juce::DynamicObject();
+            pass->setProperty ("blockSize",            r.blockSize);
+            pass->setProperty ("pass",                 r.pass);
+            pass->setProperty ("audioSeconds",         r.audioSeconds);
+            pass->setProperty ("processSeconds",       r.processSeconds);
+            pass->setProperty ("realtimeFactor",       r.audioSeconds / r.processSeconds);
+            pass->setProperty ("blockMicrosecondsP50", r.p50Microseconds);
+            pass->setProperty ("blockMicrosecondsP99", r.p99Microseconds);
+            pass->setProperty ("blockMicrosecondsMax", r.maxMicroseconds);
+            passes.add (pass);
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("plugin",       processor.getName());
+        root->setProperty ("input",        options.inputFile.getFullPathName());
+        root->setProperty ("sampleRate",   sampleRate);
+        root->setProperty ("channels",     processor.getMainBusNumOutputChannels());
+        root->setProperty ("peakRssBytes", getPeakResidentSetBytes());
+        root->setProperty ("passes",       passes);
+        return root;
+    }
+
+    int run (const Options& options)
+    {
+        auto formatManager = std::make_unique<juce::AudioFormatManager>();
+        formatManager->registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager->createReaderFor (options.inputFile));
+
+        if (reader == nullptr)
+        {
+            std::fprintf (stderr, "Could not open %s\n", options.inputFile.getFullPathName().toRawUTF8());
+            return 1;
+        }
+
+        std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+
+        const auto channelsResult = setMainBusChannels (*processor, options.numChannels > 0 ? options.numChannels : static_cast<int> (reader->numChannels));
+
+        if (channelsResult.failed())
+        {
+            std::fprintf (stderr, "%s\n", channelsResult.getErrorMessage().toRawUTF8());
+            return 1;
+        }
+
+        std::vector<AutomationPoint> automation;
+
+        if (options.automationFile != juce::File())
+        {
+            const auto automationResult = loadAutomation (options.automationFile, *processor, automation);
+
+            if (automationResult.failed())
+            {
+                std::fprintf (stderr, "%s\n", automationResult.getErrorMessage().toRawUTF8());
+                return 1;
+            }
+        }
+
+        // The parameter values at the start of each pass, so that all passes render the same automation
+        std::vector<float> initialValues;
+
+        for (auto* p : processor->getParameters())
+            initialValues.push_back (p->getValue());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (options.outputFile != juce::File())
+        {
+            options.outputFile.deleteFile();
+            auto stream = options.outputFile.createOutputStream();
+
+            if (stream != nullptr)
+                writer.reset (juce::WavAudioFormat().createWriterFor (stream.get(), reader->sampleRate,
+                                                                      static_cast<unsigned int> (processor->getTotalNumOutputChannels()),
+                                                                      24, {}, 0));
+
+            if (writer == nullptr)
+            {
+                std::fprintf (stderr, "Could not create %s\n", options.outputFile.getFullPathName().toRawUTF8());
+                return 1;
+            }
+
+            // The writer owns the stream now
+            stream.release();
+        }
+
+        std::printf ("%s, %s, %.0f Hz, %d channels\n",
+                     processor->getName().toRawUTF8(), options.inputFile.getFileName().toRawUTF8(),
+                     reader->sampleRate, processor->getMainBusNumOutputChannels());
+
+        std::vector<PassResult> results;
+
+        for (auto blockSize : options.blockSizes)
+        {
+            for (int pass = 0; pass < options.numPasses; ++pass)
+            {
+                const auto& parameters = processor->getParameters();
+
+                for (int i = 0; i < parameters.size(); ++i)
+                    parameters[i]->setValueNotifyingHost (initialValues[static_cast<size_t> (i)]);
+
+                processor->reset();
+
+                results.push_back (runPass (*processor, *reader, blockSize, pass, automation, results.empty() ? writer.get() : nullptr));
+
+                const auto& r = results.back();
+                std::printf ("block size %5d pass %d: realtime factor %8.1fx, block time p50 %9.2f us, p99 %9.2f us, max %9.2f us\n",
+                             r.blockSize, r.pass, r.audioSeconds / r.processSeconds, r.p50Microseconds, r.p99Microseconds, r.maxMicroseconds);
+            }
+        }
+
+        // Flushes the output file
+        writer.reset();
+
+        const auto peakRss = getPeakResidentSetBytes();
+
+        if (peakRss >= 0)
+            std::printf ("peak rss %.1f MiB\n", static_cast<double> (peakRss) / (1024.0 * 1024.0));
+
+        if (options.jsonFile != juce::File())
+        {
+            const auto json = toJson (options, *processor, reader->sampleRate, results);
+
+            if (! options.jsonFile.replaceWithText (juce::JSON::toString (json)))
+            {
+                std::fprintf (stderr, "Could not write %s\n", options.jsonFile.getFullPathName().toRawUTF8());
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList args (argc, argv);
+
+    // Missing files passed to the options are reported through ConsoleApplication::fail
+    return juce::ConsoleApplication::invokeCatchingFailures ([&]
+    {
+        jb::render::Options options;
+
+        if (args.containsOption ("--help|-h") || ! jb::render::parseOptions (args, options))
+        {
+            jb::render::printUsage();
+            return args.containsOption ("--help|-h") ? 0 : 1;
+        }
+
+        return jb::render::run (options);
+    });
+}
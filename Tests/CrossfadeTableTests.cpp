@@ -0,0 +1,131 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+namespace jb::tests
+{
+
+class CrossfadeTableTests : public juce::UnitTest
+{
+public:
+    CrossfadeTableTests() : juce::UnitTest ("CrossfadeTable", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        for (auto shape : { CrossfadeShape::linear, CrossfadeShape::equalPower, CrossfadeShape::sCurve })
+        {
+            const juce::String shapeName = shape == CrossfadeShape::linear     ? "linear"
+                                         : shape == CrossfadeShape::equalPower ? "equal power"
+                                                                               : "s-curve";
+
+            beginTest ("Gain curves, " + shapeName);
+            testGainCurves (shape);
+
+            beginTest ("Split fades, " + shapeName);
+            testSplitFade (shape);
+        }
+    }
+
+private:
+    static constexpr int rampLength = 64;
+
+    void testGainCurves (CrossfadeShape shape)
+    {
+        const CrossfadeTable<float> table (rampLength, shape);
+
+        expectEquals (table.getLength(), rampLength);
+
+        const std::vector<float> ones  (rampLength, 1.0f);
+        const std::vector<float> zeros (rampLength, 0.0f);
+        std::vector<float> wetGains (rampLength), dryGains (rampLength);
+
+        table.crossfade (wetGains.data(), ones.data(),  zeros.data(), 0, rampLength);
+        table.crossfade (dryGains.data(), zeros.data(), ones.data(),  0, rampLength);
+
+        // The last ramp position reaches the fully wet signal
+        expectWithinAbsoluteError (wetGains.back(), 1.0f, 1.0e-6f);
+        expectWithinAbsoluteError (dryGains.back(), 0.0f, 1.0e-6f);
+
+        auto isMonotonic = true;
+        auto maxSumError = 0.0f;
+
+        for (size_t i = 0; i < static_cast<size_t> (rampLength); ++i)
+        {
+            if (i > 0)
+                isMonotonic &= wetGains[i] > wetGains[i - 1] && dryGains[i] < dryGains[i - 1];
+
+            const auto sum = shape == CrossfadeShape::equalPower ? wetGains[i] * wetGains[i] + dryGains[i] * dryGains[i]
+                                                                 : wetGains[i] + dryGains[i];
+
+            maxSumError = std::max (maxSumError, std::abs (sum - 1.0f));
+        }
+
+        expect (isMonotonic);
+        expectLessOrEqual (maxSumError, 1.0e-6f);
+    }
+
+    void testSplitFade (CrossfadeShape shape)
+    {
+        auto& random = getRandom();
+
+        const CrossfadeTable<float> table (rampLength, shape);
+
+        std::vector<float> wet (rampLength), dry (rampLength), whole (rampLength);
+
+        for (size_t i = 0; i < static_cast<size_t> (rampLength); ++i)
+        {
+            wet[i] = random.nextFloat() * 2.0f - 1.0f;
+            dry[i] = random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        table.crossfade (whole.data(), wet.data(), dry.data(), 0, rampLength);
+
+        // A fade split into several ranges gives the same result as a single pass, also when written in place
+        auto split = wet;
+        const int boundaries[] = { 0, 1, 17, 17, 50, rampLength };
+
+        for (size_t i = 1; i < std::size (boundaries); ++i)
+            table.crossfade (split.data() + boundaries[i - 1], split.data() + boundaries[i - 1], dry.data() + boundaries[i - 1], boundaries[i - 1], boundaries[i]);
+
+        expect (split == whole);
+
+        // Written in place into the dry signal, the gains are applied in the opposite order
+        auto splitDry = dry;
+
+        for (size_t i = 1; i < std::size (boundaries); ++i)
+            table.crossfade (splitDry.data() + boundaries[i - 1], wet.data() + boundaries[i - 1], splitDry.data() + boundaries[i - 1], boundaries[i - 1], boundaries[i]);
+
+        auto maxError = 0.0f;
+
+        for (size_t i = 0; i < static_cast<size_t> (rampLength); ++i)
+            maxError = std::max (maxError, std::abs (splitDry[i] - whole[i]));
+
+        expectLessOrEqual (maxError, 1.0e-6f);
+    }
+};
+
+static CrossfadeTableTests crossfadeTableTests;
+
+}
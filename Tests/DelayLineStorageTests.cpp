@@ -0,0 +1,88 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "TestSignals.h"
+
+namespace jb::tests
+{
+
+class DelayLineStorageTests : public juce::UnitTest
+{
+public:
+    DelayLineStorageTests() : juce::UnitTest ("DelayLine storage policies", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("Interleaved");
+        testStoragePolicy<DelayLineStorage::Interleaved>();
+
+        beginTest ("Lane grouped by 4");
+        testStoragePolicy<DelayLineStorage::LaneGrouped<4>>();
+
+        beginTest ("Lane grouped by 8");
+        testStoragePolicy<DelayLineStorage::LaneGrouped<8>>();
+    }
+
+private:
+    template <typename StoragePolicy>
+    void testStoragePolicy()
+    {
+        // A channel count that is no multiple of the group sizes leaves a partially used group
+        constexpr int length      = 100;
+        constexpr int numChannels = 5;
+
+        auto& random = getRandom();
+
+        MultichannelDelayLine<float, StoragePolicy> delayLine (length, numChannels);
+        SignalHistory history (numChannels);
+
+        juce::AudioBuffer<float> src  (numChannels, 3 * length);
+        juce::AudioBuffer<float> dest (numChannels, 3 * length);
+
+        for (int block = 0; block < 200; ++block)
+        {
+            const auto numSamples = 1 + random.nextInt (3 * length);
+            const auto firstPosition = history.size();
+
+            fillWithNoise (src, numSamples, history, random);
+
+            const auto srcBlock = juce::dsp::AudioBlock<float> (src).getSubBlock (0, static_cast<size_t> (numSamples));
+            auto destBlock      = juce::dsp::AudioBlock<float> (dest).getSubBlock (0, static_cast<size_t> (numSamples));
+
+            delayLine.processBlock (srcBlock, destBlock);
+
+            auto matches = true;
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numSamples; ++i)
+                    matches &= juce::exactlyEqual (dest.getSample (c, i), history.get (c, firstPosition + i - length));
+
+            expect (matches, "block " + juce::String (block) + " of " + juce::String (numSamples) + " samples");
+        }
+    }
+};
+
+static DelayLineStorageTests delayLineStorageTests;
+
+}
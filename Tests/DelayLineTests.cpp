@@ -0,0 +1,217 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "TestSignals.h"
+
+namespace jb::tests
+{
+
+class MultichannelDelayLineTests : public juce::UnitTest
+{
+public:
+    MultichannelDelayLineTests() : juce::UnitTest ("MultichannelDelayLine", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        for (auto layout : { DelayLineMemoryLayout::ring, DelayLineMemoryLayout::mirrored })
+        {
+            const juce::String layoutName = layout == DelayLineMemoryLayout::ring ? "ring" : "mirrored";
+
+            beginTest ("Constant delay, " + layoutName);
+            testDelayChanges (layout, false, 0);
+
+            beginTest ("Delay changes without crossfade, " + layoutName);
+            testDelayChanges (layout, true, 0);
+
+            beginTest ("Delay changes with crossfade, " + layoutName);
+            testDelayChanges (layout, true, 50);
+
+            beginTest ("Per sample interface, " + layoutName);
+            testPerSampleInterface (layout);
+        }
+
+        beginTest ("Read pointer");
+        testReadPointer();
+    }
+
+private:
+    static constexpr int length      = 100;
+    static constexpr int numChannels = 2;
+
+    // Blocks of up to three times the length exercise the wrap around and blocks longer than the memory
+    static constexpr int maxBlockSize = 3 * length;
+
+    /** The crossfade between the old and the new delay time, as documented for setDelay */
+    struct ExpectedDelay
+    {
+        int delay = length, previousDelay = length, fadeLength = 0;
+        std::vector<int> fadePositions = std::vector<int> (numChannels, 0);
+
+        void setDelay (int newDelay, int crossfadeLength)
+        {
+            if (newDelay == delay)
+                return;
+
+            previousDelay = delay;
+            delay         = newDelay;
+            fadeLength    = crossfadeLength;
+
+            std::fill (fadePositions.begin(), fadePositions.end(), 0);
+        }
+
+        float getSample (const SignalHistory& history, int channel, int64_t position)
+        {
+            const auto target = history.get (channel, position - delay);
+            auto& fadePosition = fadePositions[static_cast<size_t> (channel)];
+
+            if (fadePosition >= fadeLength)
+                return target;
+
+            const auto previous = history.get (channel, position - previousDelay);
+            const auto gain = static_cast<float> (fadePosition + 1) / static_cast<float> (fadeLength);
+            ++fadePosition;
+
+            return previous + gain * (target - previous);
+        }
+    };
+
+    void testDelayChanges (DelayLineMemoryLayout layout, bool changeDelay, int crossfadeLength)
+    {
+        auto& random = getRandom();
+
+        MultichannelDelayLine<float> delayLine (length, numChannels, layout);
+        ExpectedDelay expected;
+        SignalHistory history (numChannels);
+
+        juce::AudioBuffer<float> src  (numChannels, maxBlockSize);
+        juce::AudioBuffer<float> dest (numChannels, maxBlockSize);
+
+        for (int block = 0; block < 300; ++block)
+        {
+            // Changes happen at random block boundaries, also while a previous crossfade is still running
+            if (changeDelay && random.nextInt (4) == 0)
+            {
+                const auto newDelay = random.nextInt (length + 1);
+                delayLine.setDelay (newDelay, crossfadeLength);
+                expected.setDelay (newDelay, crossfadeLength);
+            }
+
+            const auto numSamples = 1 + random.nextInt (maxBlockSize);
+            const auto firstPosition = history.size();
+
+            fillWithNoise (src, numSamples, history, random);
+
+            // Blocks that are only pushed advance a running crossfade just like the processed ones
+            if (random.nextInt (5) == 0)
+            {
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    delayLine.pushBuffer (src.getReadPointer (c), numSamples, c);
+
+                    for (int i = 0; i < numSamples; ++i)
+                        expected.getSample (history, c, firstPosition + i);
+                }
+
+                continue;
+            }
+
+            const auto srcBlock = juce::dsp::AudioBlock<float> (src).getSubBlock (0, static_cast<size_t> (numSamples));
+            auto destBlock      = juce::dsp::AudioBlock<float> (dest).getSubBlock (0, static_cast<size_t> (numSamples));
+
+            delayLine.processBlock (srcBlock, destBlock);
+
+            auto maxError = 0.0f;
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = std::max (maxError, std::abs (dest.getSample (c, i) - expected.getSample (history, c, firstPosition + i)));
+
+            expectLessOrEqual (maxError, 1.0e-6f, "block " + juce::String (block) + " of " + juce::String (numSamples) + " samples");
+        }
+
+        expectEquals (delayLine.getDelay(), expected.delay);
+    }
+
+    void testPerSampleInterface (DelayLineMemoryLayout layout)
+    {
+        auto& random = getRandom();
+
+        MultichannelDelayLine<float> delayLine (length, numChannels, layout);
+        SignalHistory history (numChannels);
+
+        for (int i = 0; i < 5 * length; ++i)
+        {
+            if (i % 37 == 0)
+                delayLine.setDelay (1 + random.nextInt (length));
+
+            // back returns the sample pushed delay samples before the one that will be pushed next
+            for (int c = 0; c < numChannels; ++c)
+                expectEquals (delayLine.back (c), history.get (c, history.size() - delayLine.getDelay()));
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const auto sample = random.nextFloat();
+                delayLine.push (sample, c);
+                history.push (sample, c);
+            }
+        }
+    }
+
+    void testReadPointer()
+    {
+        auto& random = getRandom();
+
+        MultichannelDelayLine<float> delayLine (length, numChannels, DelayLineMemoryLayout::mirrored);
+        SignalHistory history (numChannels);
+
+        juce::AudioBuffer<float> src (numChannels, maxBlockSize);
+
+        for (int block = 0; block < 100; ++block)
+        {
+            const auto numSamples = 1 + random.nextInt (maxBlockSize);
+            fillWithNoise (src, numSamples, history, random);
+
+            for (int c = 0; c < numChannels; ++c)
+                delayLine.pushBuffer (src.getReadPointer (c), numSamples, c);
+
+            // The window behind the pointer holds the last numSamplesAgo samples in chronological order
+            const auto numSamplesAgo = 1 + random.nextInt (length);
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const auto* window = delayLine.getReadPointer (c, numSamplesAgo);
+                auto matches = true;
+
+                for (int i = 0; i < numSamplesAgo; ++i)
+                    matches &= juce::exactlyEqual (window[i], history.get (c, history.size() - numSamplesAgo + i));
+
+                expect (matches, "block " + juce::String (block) + ", " + juce::String (numSamplesAgo) + " samples ago");
+            }
+        }
+    }
+};
+
+static MultichannelDelayLineTests multichannelDelayLineTests;
+
+}
@@ -0,0 +1,113 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "TestSignals.h"
+
+namespace jb::tests
+{
+
+class FixedMultichannelDelayLineTests : public juce::UnitTest
+{
+public:
+    FixedMultichannelDelayLineTests() : juce::UnitTest ("FixedMultichannelDelayLine", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("Length 1");
+        testLength<1>();
+
+        beginTest ("Power of two length");
+        testLength<64>();
+
+        beginTest ("Other length");
+        testLength<100>();
+
+        beginTest ("Fewer channels than the delay line");
+        testFewerChannels();
+    }
+
+private:
+    static constexpr int numChannels = 2;
+
+    template <int length>
+    void testLength()
+    {
+        auto& random = getRandom();
+
+        FixedMultichannelDelayLine<float, length, numChannels> delayLine;
+        SignalHistory history (numChannels);
+
+        constexpr int maxBlockSize = 3 * length + 5;
+
+        juce::AudioBuffer<float> src  (numChannels, maxBlockSize);
+        juce::AudioBuffer<float> dest (numChannels, maxBlockSize);
+
+        for (int block = 0; block < 200; ++block)
+        {
+            const auto numSamples = 1 + random.nextInt (maxBlockSize);
+            const auto firstPosition = history.size();
+
+            fillWithNoise (src, numSamples, history, random);
+
+            const auto srcBlock = juce::dsp::AudioBlock<float> (src).getSubBlock (0, static_cast<size_t> (numSamples));
+            auto destBlock      = juce::dsp::AudioBlock<float> (dest).getSubBlock (0, static_cast<size_t> (numSamples));
+
+            delayLine.processBlock (srcBlock, destBlock);
+
+            auto matches = true;
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numSamples; ++i)
+                    matches &= juce::exactlyEqual (dest.getSample (c, i), history.get (c, firstPosition + i - length));
+
+            expect (matches, "block " + juce::String (block) + " of " + juce::String (numSamples) + " samples");
+        }
+    }
+
+    void testFewerChannels()
+    {
+        constexpr int length = 32;
+
+        FixedMultichannelDelayLine<float, length, numChannels> delayLine;
+
+        juce::AudioBuffer<float> src  (1, 2 * length);
+        juce::AudioBuffer<float> dest (1, 2 * length);
+
+        for (int i = 0; i < 2 * length; ++i)
+            src.setSample (0, i, static_cast<float> (i + 1));
+
+        juce::dsp::AudioBlock<float> srcBlock (src);
+        juce::dsp::AudioBlock<float> destBlock (dest);
+
+        delayLine.processBlock (srcBlock, destBlock);
+
+        expectEquals (dest.getSample (0, length - 1), 0.0f);
+        expectEquals (dest.getSample (0, length),     1.0f);
+        expectEquals (dest.getSample (0, 2 * length - 1), static_cast<float> (length));
+    }
+};
+
+static FixedMultichannelDelayLineTests fixedMultichannelDelayLineTests;
+
+}
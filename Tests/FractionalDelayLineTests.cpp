@@ -0,0 +1,184 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "TestSignals.h"
+
+namespace jb::tests
+{
+
+class FractionalDelayLineTests : public juce::UnitTest
+{
+public:
+    FractionalDelayLineTests() : juce::UnitTest ("FractionalDelayLine", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("Integer delays are exact, linear");
+        testIntegerDelay<DelayLineInterpolation::Linear>();
+
+        beginTest ("Integer delays are exact, Lagrange");
+        testIntegerDelay<DelayLineInterpolation::Lagrange3rd>();
+
+        beginTest ("Integer delays are exact, Thiran");
+        testIntegerDelay<DelayLineInterpolation::Thiran>();
+
+        beginTest ("Modulated delay, linear");
+        testModulatedLinearDelay();
+
+        beginTest ("Fractional delay of a sine, Lagrange");
+        testFractionalSineDelay<DelayLineInterpolation::Lagrange3rd> (1.0e-4f);
+
+        beginTest ("Fractional delay of a sine, Thiran");
+        testFractionalSineDelay<DelayLineInterpolation::Thiran> (1.0e-3f);
+    }
+
+private:
+    static constexpr int maxDelay   = 100;
+    static constexpr int blockSize  = 64;
+    static constexpr int numBlocks  = 20;
+
+    // More channels than fit into a single SIMD register, so that the last group is only partially used
+    static constexpr int numChannels = 5;
+
+    template <typename Interpolator>
+    void testIntegerDelay()
+    {
+        auto& random = getRandom();
+
+        FractionalDelayLine<float, Interpolator> delayLine (maxDelay, numChannels);
+        SignalHistory history (numChannels);
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Stays at least one sample apart from the minimum delay of the Lagrange interpolator
+            const auto delay = 1 + random.nextInt (maxDelay);
+            const auto firstPosition = history.size();
+
+            fillWithNoise (buffer, blockSize, history, random);
+
+            // Processed in place, which the delay line supports
+            juce::dsp::AudioBlock<float> audioBlock (buffer);
+            delayLine.processBlock (audioBlock, audioBlock, static_cast<float> (delay));
+
+            auto maxError = 0.0f;
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = std::max (maxError, std::abs (buffer.getSample (c, i) - history.get (c, firstPosition + i - delay)));
+
+            expectLessOrEqual (maxError, 1.0e-6f, "delay of " + juce::String (delay) + " samples");
+        }
+    }
+
+    void testModulatedLinearDelay()
+    {
+        auto& random = getRandom();
+
+        FractionalDelayLine<float> delayLine (maxDelay, numChannels);
+        SignalHistory history (numChannels);
+
+        juce::AudioBuffer<float> src  (numChannels, blockSize);
+        juce::AudioBuffer<float> dest (numChannels, blockSize);
+        std::vector<float> delays (blockSize);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto firstPosition = history.size();
+
+            fillWithNoise (src, blockSize, history, random);
+
+            // Sweeps over the whole range including values that get clipped
+            for (int i = 0; i < blockSize; ++i)
+                delays[static_cast<size_t> (i)] = random.nextFloat() * (maxDelay + 10.0f) - 5.0f;
+
+            juce::dsp::AudioBlock<float> srcBlock (src);
+            juce::dsp::AudioBlock<float> destBlock (dest);
+
+            delayLine.processBlock (srcBlock, destBlock, delays.data());
+
+            auto maxError = 0.0f;
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const auto delay = juce::jlimit (0.0f, static_cast<float> (maxDelay), delays[static_cast<size_t> (i)]);
+                    const auto delayInt = static_cast<int> (delay);
+                    const auto delayFrac = delay - static_cast<float> (delayInt);
+
+                    const auto x0 = history.get (c, firstPosition + i - delayInt);
+                    const auto x1 = history.get (c, firstPosition + i - delayInt - 1);
+
+                    maxError = std::max (maxError, std::abs (dest.getSample (c, i) - (x0 + (x1 - x0) * delayFrac)));
+                }
+            }
+
+            expectLessOrEqual (maxError, 1.0e-5f);
+        }
+    }
+
+    /** A low frequency sine is delayed by the fractional amount with an error far below the one of linear interpolation */
+    template <typename Interpolator>
+    void testFractionalSineDelay (float tolerance)
+    {
+        constexpr auto delay = 10.3f;
+        constexpr auto omega = 0.02f;
+
+        FractionalDelayLine<float, Interpolator> delayLine (maxDelay, numChannels);
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+
+        auto maxError = 0.0f;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (c, i, std::sin (omega * static_cast<float> (block * blockSize + i) + static_cast<float> (c)));
+
+            juce::dsp::AudioBlock<float> audioBlock (buffer);
+            delayLine.processBlock (audioBlock, audioBlock, delay);
+
+            // Skips the first blocks, where the delay line is filled and the allpass state settles
+            if (block < 2)
+                continue;
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const auto expected = std::sin (omega * (static_cast<float> (block * blockSize + i) - delay) + static_cast<float> (c));
+                    maxError = std::max (maxError, std::abs (buffer.getSample (c, i) - expected));
+                }
+            }
+        }
+
+        expectLessOrEqual (maxError, tolerance);
+    }
+};
+
+static FractionalDelayLineTests fractionalDelayLineTests;
+
+}
@@ -0,0 +1,128 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include "TestSignals.h"
+
+namespace jb::tests
+{
+
+class MultiTapDelayLineTests : public juce::UnitTest
+{
+public:
+    MultiTapDelayLineTests() : juce::UnitTest ("MultiTapDelayLine", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("Sum of taps, processed in place");
+        testSumOfTaps();
+
+        beginTest ("Panning a mono source");
+        testPanning();
+    }
+
+private:
+    static constexpr int maxDelay = 200;
+
+    using DelayLine = MultiTapDelayLine<float>;
+
+    void testSumOfTaps()
+    {
+        constexpr int numChannels = 2;
+
+        auto& random = getRandom();
+
+        // Delays beyond the maximum are clipped, taps are passed unsorted
+        const std::vector<DelayLine::Tap> taps { { 37,            0.5f  },
+                                                 { 0,             1.0f  },
+                                                 { maxDelay,      -0.25f },
+                                                 { maxDelay + 50, 0.125f },
+                                                 { 64,            0.75f } };
+
+        DelayLine delayLine (maxDelay, numChannels);
+        delayLine.setTaps (taps);
+
+        SignalHistory history (numChannels);
+        juce::AudioBuffer<float> buffer (numChannels, 300);
+
+        for (int block = 0; block < 200; ++block)
+        {
+            const auto numSamples = 1 + random.nextInt (300);
+            const auto firstPosition = history.size();
+
+            fillWithNoise (buffer, numSamples, history, random);
+
+            auto audioBlock = juce::dsp::AudioBlock<float> (buffer).getSubBlock (0, static_cast<size_t> (numSamples));
+            delayLine.processBlock (audioBlock, audioBlock);
+
+            auto maxError = 0.0f;
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto expected = 0.0f;
+
+                    for (const auto& tap : taps)
+                        expected += tap.gain * history.get (c, firstPosition + i - std::min (tap.delayInSamples, maxDelay));
+
+                    maxError = std::max (maxError, std::abs (buffer.getSample (c, i) - expected));
+                }
+            }
+
+            expectLessOrEqual (maxError, 1.0e-5f, "block of " + juce::String (numSamples) + " samples");
+        }
+    }
+
+    void testPanning()
+    {
+        // Hard panned taps only reach one output channel
+        DelayLine delayLine (maxDelay, 1);
+        delayLine.setTaps ({ { 10, 1.0f, -1.0f }, { 20, 0.5f, 1.0f } });
+
+        SignalHistory history (1);
+        juce::AudioBuffer<float> src  (1, 128);
+        juce::AudioBuffer<float> dest (2, 128);
+
+        fillWithNoise (src, 128, history, getRandom());
+
+        juce::dsp::AudioBlock<float> srcBlock (src);
+        juce::dsp::AudioBlock<float> destBlock (dest);
+
+        delayLine.processBlock (srcBlock, destBlock);
+
+        auto maxError = 0.0f;
+
+        for (int i = 0; i < 128; ++i)
+        {
+            maxError = std::max (maxError, std::abs (dest.getSample (0, i) - history.get (0, i - 10)));
+            maxError = std::max (maxError, std::abs (dest.getSample (1, i) - 0.5f * history.get (0, i - 20)));
+        }
+
+        expectLessOrEqual (maxError, 1.0e-5f);
+    }
+};
+
+static MultiTapDelayLineTests multiTapDelayLineTests;
+
+}
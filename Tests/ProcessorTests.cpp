@@ -0,0 +1,426 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+namespace jb::tests
+{
+
+namespace
+{
+    struct TestParameters
+    {
+        struct Gain
+        {
+            static constexpr auto id           = "gain";
+            static constexpr auto name         = "Gain";
+            static constexpr auto range        = ParameterRange<float> { -24.0f, 24.0f };
+            static constexpr auto defaultValue = 0.0f;
+        };
+
+        struct Mode
+        {
+            static constexpr auto id           = "mode";
+            static constexpr auto name         = "Mode";
+            static constexpr auto range        = ParameterRange<int> { 0, 4 };
+            static constexpr auto defaultValue = 0;
+        };
+
+        struct Bypass
+        {
+            static constexpr auto id           = "bypass";
+            static constexpr auto name         = "Bypass";
+            static constexpr auto defaultValue = false;
+        };
+
+        using Parameters = ParameterList<Gain, Mode, Bypass>;
+
+        static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
+        {
+            return Parameters::createParameterLayout();
+        }
+
+        static juce::StringArray getPresetManagerParameters()
+        {
+            return { Gain::id, Mode::id };
+        }
+    };
+
+    /** Declares the latency of the LatentProcessor at compile time, so that the base uses a fixed bypass delay line */
+    struct FixedLatencyParameters : TestParameters
+    {
+        struct FixedLatency
+        {
+            static constexpr int numSamples     = 40;
+            static constexpr int maxNumChannels = 2;
+        };
+    };
+
+    JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE ("-Woverloaded-virtual")
+
+    template <class Parameters = TestParameters>
+    class TestProcessorBase : public PluginAudioProcessorBase<Parameters>
+    {
+    public:
+        void prepareResources (bool, bool, bool) override {}
+
+        juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override                     { return false; }
+
+        // The host facing AudioProcessor functions are private in the base, just like for a plugin wrapper they are only
+        // reachable through the AudioProcessor interface
+        void prepare (int maxBlockSize)
+        {
+            asAudioProcessor().prepareToPlay (48000.0, maxBlockSize);
+        }
+
+        void setBypassed (bool shouldBeBypassed)
+        {
+            asAudioProcessor().getBypassParameter()->setValueNotifyingHost (shouldBeBypassed ? 1.0f : 0.0f);
+        }
+
+        /** Processes a mono block through the host facing processBlock and returns the output */
+        std::vector<float> process (const std::vector<float>& input)
+        {
+            juce::AudioBuffer<float> buffer (1, static_cast<int> (input.size()));
+            juce::MidiBuffer midi;
+
+            std::copy (input.begin(), input.end(), buffer.getWritePointer (0));
+            asAudioProcessor().processBlock (buffer, midi);
+
+            return { buffer.getReadPointer (0), buffer.getReadPointer (0) + input.size() };
+        }
+
+    private:
+        juce::AudioProcessor& asAudioProcessor() { return *this; }
+    };
+
+    /** Halves the signal, so that the processed and the bypassed signal differ */
+    class HalfGainProcessor : public TestProcessorBase<>
+    {
+    public:
+        void processBlock (juce::dsp::AudioBlock<float>& block) override
+        {
+            block.multiplyBy (0.5f);
+        }
+    };
+
+    /** Delays the signal by the latency it reports, so that the processed signal equals the latency compensated input */
+    template <class Parameters>
+    class LatentProcessor : public TestProcessorBase<Parameters>
+    {
+    public:
+        static constexpr int latency = 40;
+
+        LatentProcessor()
+        {
+            this->setMaximumLatencySamples (latency);
+            this->setLatencySamples (latency);
+        }
+
+        /** Switches the delay without a crossfade, like switching a lookahead setting would */
+        void changeLatency (int newLatency)
+        {
+            delayLine.setDelay (newLatency);
+            this->setLatencySamples (newLatency);
+        }
+
+        void prepareResources (bool, bool, bool) override
+        {
+            delayLine.reset();
+            scratch.resize (this->createProcessSpec (1).maximumBlockSize);
+        }
+
+        void processBlock (juce::dsp::AudioBlock<float>& block) override
+        {
+            const auto numSamples = block.getNumSamples();
+
+            std::copy_n (block.getChannelPointer (0), numSamples, scratch.data());
+            delayLine.processBuffer (scratch.data(), block.getChannelPointer (0), static_cast<int> (numSamples), 0);
+        }
+
+    private:
+        MultichannelDelayLine<float> delayLine { latency };
+        std::vector<float> scratch;
+    };
+
+    /** Passes frames through unchanged, so that the output equals the input delayed by the frame fifo */
+    class FrameProcessor : public TestProcessorBase<>
+    {
+    public:
+        static constexpr int frameSize = 64;
+
+        FrameProcessor()
+        {
+            setRequiredFrameSize (frameSize);
+        }
+
+        void processBlock (juce::dsp::AudioBlock<float>& block) override
+        {
+            allFramesComplete &= block.getNumSamples() == frameSize;
+        }
+
+        bool allFramesComplete = true;
+    };
+
+    /** Records which parameters were flagged as changed in each block */
+    class ChangeTrackingProcessor : public TestProcessorBase<>
+    {
+    public:
+        struct Changes
+        {
+            bool gain, mode;
+        };
+
+        std::vector<Changes> changes;
+
+        void processBlock (juce::dsp::AudioBlock<float>&) override
+        {
+            changes.push_back ({ hasParameterChanged<TestParameters::Gain>(), hasParameterChanged<TestParameters::Mode>() });
+        }
+    };
+
+    JUCE_END_IGNORE_WARNINGS_GCC_LIKE
+}
+
+//======================================================================================================================
+class PluginAudioProcessorBaseTests : public juce::UnitTest
+{
+public:
+    PluginAudioProcessorBaseTests() : juce::UnitTest ("PluginAudioProcessorBase", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("Bypass fade is continuous");
+        testBypassFadeContinuity();
+
+        beginTest ("Bypass is latency compensated");
+        testLatencyCompensatedBypass<LatentProcessor<TestParameters>>();
+
+        beginTest ("Bypass is latency compensated, fixed latency");
+        testLatencyCompensatedBypass<LatentProcessor<FixedLatencyParameters>>();
+
+        beginTest ("Bypass follows latency changes made while processing");
+        testLatencyChangeWhileProcessing();
+
+        beginTest ("Frame mode");
+        testFrameMode();
+
+        beginTest ("Bypass is latency compensated, frame mode");
+        testLatencyCompensatedBypass<FrameProcessor>();
+
+        beginTest ("Parameter changes are flagged once");
+        testParameterChanges();
+    }
+
+private:
+    void testBypassFadeContinuity()
+    {
+        // At 48 kHz, a fade of 48 samples spans three blocks, so it is also reversed while it is running
+        constexpr int blockSize  = 16;
+        constexpr int fadeLength = 48;
+
+        HalfGainProcessor processor;
+        processor.setBypassFadeLength (1.0);
+        processor.prepare (blockSize);
+
+        const std::vector<float> ones (blockSize, 1.0f);
+        std::vector<float> output;
+
+        for (int block = 0; block < 24; ++block)
+        {
+            if (block == 4)  processor.setBypassed (true);
+            if (block == 6)  processor.setBypassed (false);
+            if (block == 12) processor.setBypassed (true);
+
+            const auto blockOutput = processor.process (ones);
+            output.insert (output.end(), blockOutput.begin(), blockOutput.end());
+        }
+
+        // The output moves between the processed and the bypassed level by at most one fade step per sample
+        auto maxStep = 0.0f;
+
+        for (size_t i = 1; i < output.size(); ++i)
+            maxStep = std::max (maxStep, std::abs (output[i] - output[i - 1]));
+
+        expectLessOrEqual (maxStep, 0.5f / static_cast<float> (fadeLength) + 1.0e-6f);
+
+        expectEquals (output[4 * blockSize - 1], 0.5f);
+        expectGreaterThan (output[6 * blockSize - 1], 0.5f);
+        expectEquals (output[12 * blockSize - 1], 0.5f);
+        expectEquals (output.back(), 1.0f);
+    }
+
+    void testLatencyChangeWhileProcessing()
+    {
+        constexpr int blockSize  = 32;
+        constexpr int newLatency = 20;
+
+        LatentProcessor<TestParameters> processor;
+        processor.setBypassFadeLength (1.0);
+        processor.prepare (blockSize);
+
+        auto& random = getRandom();
+
+        std::vector<float> input;
+        auto maxError = 0.0f;
+
+        for (int block = 0; block < 40; ++block)
+        {
+            if (block == 4)  processor.changeLatency (newLatency);
+            if (block == 20) processor.setBypassed (true);
+
+            std::vector<float> blockInput (blockSize);
+
+            for (auto& sample : blockInput)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            const auto firstPosition = input.size();
+            input.insert (input.end(), blockInput.begin(), blockInput.end());
+
+            const auto blockOutput = processor.process (blockInput);
+
+            // The bypass delay line crossfades to the new latency while processing, so the bypass fade is seamless
+            if (block >= 12)
+                for (size_t i = 0; i < blockOutput.size(); ++i)
+                    maxError = std::max (maxError, std::abs (blockOutput[i] - input[firstPosition + i - newLatency]));
+        }
+
+        expectLessOrEqual (maxError, 1.0e-5f);
+    }
+
+    void testFrameMode()
+    {
+        auto& random = getRandom();
+
+        FrameProcessor processor;
+        processor.prepare (100);
+
+        expectEquals (processor.getLatencySamples(), FrameProcessor::frameSize);
+
+        for (int block = 0; block < 50; ++block)
+            processor.process (std::vector<float> (static_cast<size_t> (1 + random.nextInt (100)), 0.5f));
+
+        expect (processor.allFramesComplete);
+    }
+
+    template <class Processor>
+    void testLatencyCompensatedBypass()
+    {
+        // A fade of 144 samples spans several blocks, so that the toggles below reverse running fades
+        constexpr int maxBlockSize = 32;
+
+        auto& random = getRandom();
+
+        for (int run = 0; run < 10; ++run)
+        {
+            Processor processor;
+            processor.setBypassFadeLength (3.0);
+            processor.prepare (maxBlockSize);
+
+            const auto firstToggle = 1 + random.nextInt (10);
+            const auto latency = static_cast<size_t> (processor.getLatencySamples());
+
+            std::vector<float> input;
+            auto maxError = 0.0f;
+
+            for (int block = 0; block < firstToggle + 30; ++block)
+            {
+                // The processor is left bypassed, as its own delay line is not fed and outdated once the fade is over
+                if (block == firstToggle)     processor.setBypassed (true);
+                if (block == firstToggle + 2) processor.setBypassed (false);
+                if (block == firstToggle + 4) processor.setBypassed (true);
+
+                // Host buffer sizes change from block to block
+                std::vector<float> blockInput (static_cast<size_t> (1 + random.nextInt (maxBlockSize)));
+
+                for (auto& sample : blockInput)
+                    sample = random.nextFloat() * 2.0f - 1.0f;
+
+                const auto firstPosition = input.size();
+                input.insert (input.end(), blockInput.begin(), blockInput.end());
+
+                const auto blockOutput = processor.process (blockInput);
+
+                // The processed and the bypassed signal are identical, so the fades must not change anything either
+                for (size_t i = 0; i < blockOutput.size(); ++i)
+                {
+                    const auto position = firstPosition + i;
+                    const auto expected = position >= latency ? input[position - latency] : 0.0f;
+
+                    maxError = std::max (maxError, std::abs (blockOutput[i] - expected));
+                }
+            }
+
+            expectLessOrEqual (maxError, 1.0e-5f, "bypassed after " + juce::String (firstToggle) + " blocks");
+        }
+    }
+
+    void testParameterChanges()
+    {
+        constexpr int blockSize = 64;
+
+        ChangeTrackingProcessor processor;
+        processor.setBypassFadeLength (1.0);
+        processor.prepare (blockSize);
+
+        const std::vector<float> silence (blockSize, 0.0f);
+
+        // All parameters count as changed in the first block
+        processor.process (silence);
+        processor.process (silence);
+        processor.parameters.getParameter (TestParameters::Mode::id)->setValueNotifyingHost (0.25f);
+        processor.process (silence);
+
+        expectEquals (static_cast<int> (processor.changes.size()), 3);
+        expect (processor.changes[0].gain && processor.changes[0].mode);
+        expect (! processor.changes[1].gain && ! processor.changes[1].mode);
+        expect (! processor.changes[2].gain && processor.changes[2].mode);
+
+        // A change while the processor is bypassed is reported once processing resumes
+        processor.setBypassed (true);
+
+        for (int i = 0; i < 4; ++i)
+            processor.process (silence);
+
+        const auto numCallsBeforeChange = processor.changes.size();
+
+        processor.parameters.getParameter (TestParameters::Gain::id)->setValueNotifyingHost (0.75f);
+        processor.process (silence);
+
+        expectEquals (processor.changes.size(), numCallsBeforeChange);
+
+        processor.setBypassed (false);
+        processor.process (silence);
+        processor.process (silence);
+
+        expectEquals (processor.changes.size(), numCallsBeforeChange + 2);
+        expect (processor.changes[numCallsBeforeChange].gain);
+        expect (! processor.changes.back().gain && ! processor.changes.back().mode);
+    }
+};
+
+static PluginAudioProcessorBaseTests pluginAudioProcessorBaseTests;
+
+}
@@ -0,0 +1,161 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+namespace jb::tests
+{
+
+class SharedExecutorTests : public juce::UnitTest
+{
+public:
+    SharedExecutorTests() : juce::UnitTest ("SharedExecutor", "jb_plugin_base") {}
+
+    void runTest() override
+    {
+        beginTest ("parallelFor runs every job exactly once");
+        testParallelFor();
+
+        beginTest ("Submitted tasks complete");
+        testTasksComplete();
+
+        beginTest ("Cancelled tasks never run");
+        testCancelPendingTasks();
+    }
+
+private:
+    using Priority = SharedExecutor::Priority;
+
+    /** Polls the condition for up to five seconds and returns its last result */
+    template <typename Condition>
+    static bool waitFor (Condition&& condition)
+    {
+        for (int i = 0; i < 5000 && ! condition(); ++i)
+            juce::Thread::sleep (1);
+
+        return condition();
+    }
+
+    void testParallelFor()
+    {
+        constexpr int numJobs   = 257;
+        constexpr int numRounds = 200;
+
+        // Two clients compete for the realtime workers, like two plugin instances on different audio threads
+        SharedExecutor::Client clientA, clientB;
+
+        // Workers only start on request, so the jobs stay on the calling thread until then
+        expectEquals (clientA.getNumWorkerThreads(), 0);
+        clientA.parallelFor (numJobs, [] (int) {});
+
+        clientA.requestRealtimeWorkers (2);
+        clientB.requestRealtimeWorkers (1);
+        expectEquals (clientA.getNumWorkerThreads(), 2);
+
+        clientB.requestRealtimeWorkers (std::numeric_limits<int>::max());
+        expectEquals (clientA.getNumWorkerThreads(), std::max (1, juce::SystemStats::getNumCpus() - 1));
+
+        std::vector<std::atomic<int>> countsA (numJobs), countsB (numJobs);
+
+        auto run = [] (SharedExecutor::Client& client, std::vector<std::atomic<int>>& counts)
+        {
+            for (int round = 0; round < numRounds; ++round)
+                client.parallelFor (numJobs, [&counts] (int index) { counts[static_cast<size_t> (index)].fetch_add (1); });
+        };
+
+        std::thread otherAudioThread ([&] { run (clientB, countsB); });
+        run (clientA, countsA);
+        otherAudioThread.join();
+
+        auto allRanOnce = true;
+
+        for (size_t i = 0; i < static_cast<size_t> (numJobs); ++i)
+            allRanOnce &= countsA[i].load() == numRounds && countsB[i].load() == numRounds;
+
+        expect (allRanOnce);
+        expectEquals (clientA.getStatistics().realtimeJobsExecuted + clientB.getStatistics().realtimeJobsExecuted,
+                      static_cast<int64_t> (2 * numJobs * numRounds + numJobs));
+    }
+
+    void testTasksComplete()
+    {
+        constexpr int numTasks = 300;
+
+        SharedExecutor::Client client;
+        std::atomic<int> numRun { 0 };
+
+        for (int i = 0; i < numTasks; ++i)
+            client.submit ([&numRun] { ++numRun; }, static_cast<Priority> (i % 3));
+
+        expect (waitFor ([&] { return client.getStatistics().tasksCompleted == numTasks; }));
+
+        const auto statistics = client.getStatistics();
+
+        expectEquals (numRun.load(), numTasks);
+        expectEquals (statistics.tasksSubmitted, static_cast<int64_t> (numTasks));
+        expectEquals (statistics.tasksCancelled, static_cast<int64_t> (0));
+    }
+
+    void testCancelPendingTasks()
+    {
+        SharedExecutor::Client client;
+
+        std::atomic<int> numStarted { 0 }, numFinished { 0 };
+
+        // There are fewer background workers than cpu cores, so some of these tasks are still queued while the first
+        // ones block all background workers until cancelPendingTasks has removed the queued ones
+        const auto numTasks = juce::SystemStats::getNumCpus() + 16;
+
+        for (int i = 0; i < numTasks; ++i)
+        {
+            client.submit ([&]
+            {
+                ++numStarted;
+                waitFor ([&] { return client.getStatistics().tasksCancelled > 0; });
+                ++numFinished;
+            });
+        }
+
+        expect (waitFor ([&] { return numStarted.load() > 0; }));
+
+        client.cancelPendingTasks();
+
+        // Returns only after the running tasks finished
+        const auto statistics = client.getStatistics();
+
+        expectEquals (numFinished.load(), numStarted.load());
+        expectEquals (statistics.tasksCompleted, static_cast<int64_t> (numFinished.load()));
+        expectEquals (statistics.tasksCompleted + statistics.tasksCancelled, static_cast<int64_t> (numTasks));
+        expectGreaterThan (statistics.tasksCancelled, static_cast<int64_t> (0));
+
+        // Nothing that was cancelled starts later on
+        juce::Thread::sleep (20);
+        expectEquals (numStarted.load(), numFinished.load());
+        expectEquals (client.getStatistics().tasksCompleted, statistics.tasksCompleted);
+    }
+};
+
+static SharedExecutorTests sharedExecutorTests;
+
+}
@@ -0,0 +1,69 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#pragma once
+
+#include <jb_plugin_base/jb_plugin_base.h>
+
+namespace jb::tests
+{
+
+/**
+ * Keeps every sample fed into a delay line, so that the expected output can be read for any delay time. Samples before
+ * the first one are zero, just like the cleared memory of a new delay line.
+ */
+class SignalHistory
+{
+public:
+    explicit SignalHistory (int numChannels) : samples (static_cast<size_t> (numChannels)) {}
+
+    void push (float sample, int channel) { samples[static_cast<size_t> (channel)].push_back (sample); }
+
+    /** Returns the sample at the given position, counted from the first sample pushed */
+    float get (int channel, int64_t position) const
+    {
+        return position < 0 ? 0.0f : samples[static_cast<size_t> (channel)][static_cast<size_t> (position)];
+    }
+
+    int64_t size() const { return static_cast<int64_t> (samples.front().size()); }
+
+private:
+    std::vector<std::vector<float>> samples;
+};
+
+/** Fills the first numSamples of all channels with noise and appends it to the history */
+inline void fillWithNoise (juce::AudioBuffer<float>& buffer, int numSamples, SignalHistory& history, juce::Random& random)
+{
+    for (int c = 0; c < buffer.getNumChannels(); ++c)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto sample = random.nextFloat() * 2.0f - 1.0f;
+            buffer.setSample (c, i, sample);
+            history.push (sample, c);
+        }
+    }
+}
+
+}
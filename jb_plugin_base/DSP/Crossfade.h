@@ -0,0 +1,135 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/** The gain curves a CrossfadeTable can be built from */
+enum class CrossfadeShape
+{
+    /** Gains sum up to one. Best suited for fading between correlated signals such as a dry and a processed signal */
+    linear,
+
+    /** Squared gains sum up to one. Keeps the perceived loudness constant when fading between uncorrelated signals */
+    equalPower,
+
+    /** A raised cosine that starts and ends with zero slope. Gains sum up to one but the transition sounds smoother */
+    sCurve
+};
+
+/**
+ * A precomputed crossfade ramp that fades from a dry to a wet signal with a single pass over the memory involved.
+ *
+ * Both gain curves are computed once when the length or shape is set, so the audio thread only has to look them up.
+ * A fade can be split into several calls by passing consecutive ranges of ramp positions, which allows fades that span
+ * more than one block.
+ */
+template <typename SampleType>
+class CrossfadeTable
+{
+public:
+    CrossfadeTable() = default;
+
+    CrossfadeTable (int rampLength, CrossfadeShape rampShape)
+    {
+        setRamp (rampLength, rampShape);
+    }
+
+    /** Recomputes the gain tables. This allocates, so don't call it from the audio thread */
+    void setRamp (int rampLength, CrossfadeShape rampShape)
+    {
+        jassert (rampLength >= 0);
+
+        shape = rampShape;
+        wetGains.resize (static_cast<size_t> (rampLength));
+        dryGains.resize (static_cast<size_t> (rampLength));
+
+        for (int i = 0; i < rampLength; ++i)
+        {
+            // The last ramp position reaches the fully wet signal
+            const auto x = static_cast<double> (i + 1) / static_cast<double> (rampLength);
+            const auto idx = static_cast<size_t> (i);
+
+            switch (shape)
+            {
+                case CrossfadeShape::linear:
+                    wetGains[idx] = static_cast<SampleType> (x);
+                    dryGains[idx] = static_cast<SampleType> (1.0 - x);
+                    break;
+
+                case CrossfadeShape::equalPower:
+                    wetGains[idx] = static_cast<SampleType> (std::sin (x * juce::MathConstants<double>::halfPi));
+                    dryGains[idx] = static_cast<SampleType> (std::cos (x * juce::MathConstants<double>::halfPi));
+                    break;
+
+                case CrossfadeShape::sCurve:
+                {
+                    const auto wet = 0.5 - 0.5 * std::cos (x * juce::MathConstants<double>::pi);
+                    wetGains[idx] = static_cast<SampleType> (wet);
+                    dryGains[idx] = static_cast<SampleType> (1.0 - wet);
+                    break;
+                }
+            }
+        }
+    }
+
+    /**
+     * Writes dst[i] = wet[i] * wetGain (rampStart + i) + dry[i] * dryGain (rampStart + i) for all ramp positions in
+     * the range [rampStart, rampEnd). The destination may point to the same memory as wet or dry, but wet and dry must
+     * not point to the same memory.
+     *
+     * Both gains are applied with juce::FloatVectorOperations, which are vectorised for unaligned host buffers. The
+     * buffer that is shared with the destination is multiplied first, so that it is read before it gets overwritten.
+     */
+    void crossfade (SampleType* dst, const SampleType* wet, const SampleType* dry, int rampStart, int rampEnd) const noexcept
+    {
+        jassert (rampStart >= 0 && rampStart <= rampEnd && rampEnd <= getLength());
+        jassert (wet != dry);
+
+        const auto* wetGain = wetGains.data() + rampStart;
+        const auto* dryGain = dryGains.data() + rampStart;
+        const auto numSamples = rampEnd - rampStart;
+
+        if (dst == dry)
+        {
+            juce::FloatVectorOperations::multiply        (dst, dry, dryGain, numSamples);
+            juce::FloatVectorOperations::addWithMultiply (dst, wet, wetGain, numSamples);
+        }
+        else
+        {
+            juce::FloatVectorOperations::multiply        (dst, wet, wetGain, numSamples);
+            juce::FloatVectorOperations::addWithMultiply (dst, dry, dryGain, numSamples);
+        }
+    }
+
+    int getLength() const noexcept { return static_cast<int> (wetGains.size()); }
+
+    CrossfadeShape getShape() const noexcept { return shape; }
+
+private:
+    std::vector<SampleType> wetGains, dryGains;
+    CrossfadeShape shape = CrossfadeShape::linear;
+};
+
+}
@@ -25,23 +25,110 @@
 namespace jb
 {
 
+/** The way a MultichannelDelayLine lays out its history in memory */
+enum class DelayLineMemoryLayout
+{
+    /** Each channel is a circular buffer of exactly the delay length */
+    ring,
+
+    /**
+     * Each channel holds two copies of the circular buffer back to back and every sample is written to both of them.
+     * This doubles the memory and the write cost, but any window of up to the delay length into the history is a
+     * single contiguous span that can be read directly via getReadPointer.
+     */
+    mirrored
+};
+
+/** Policies that choose how a MultichannelDelayLine stores its channels in memory */
+namespace DelayLineStorage
+{
+    /** Each channel is stored in its own contiguous row and processed one after another. */
+    struct Planar {};
+
+    /**
+     * All channels of a frame are stored next to each other, so processing a block touches each cache line of the
+     * history once per frame instead of once per channel. As the blocks passed in and out are planar, each block has
+     * to be transposed on the way, so run the storage policy benchmark of jb_plugin_base_bench on your target machine
+     * to find out if this pays off for your channel count and delay length.
+     */
+    struct Interleaved {};
+
+    /**
+     * Channels are stored in groups of groupSize channels, each group is stored interleaved. Choose a group size that
+     * matches the SIMD register width, e.g. 4 or 8, to keep the inner loop over the lanes of a group vectorisable.
+     */
+    template <int groupSize>
+    struct LaneGrouped
+    {
+        static_assert (groupSize > 0, "A lane group needs at least one channel");
+    };
+}
+
 /**
- * A simple delay line implementation, designed primarily for the delayed bypass for plugins that introduce latency
+ * A simple delay line implementation, designed primarily for the delayed bypass for plugins that introduce latency.
+ *
+ * Each channel is a circular buffer of length samples. Block-wise processing moves the samples with at most two
+ * contiguous copies per channel for the read and two for the write, so delaying a block costs about as much as
+ * copying it.
+ *
+ * The delay time defaults to the length of the memory but can be changed to any shorter delay at runtime via setDelay,
+ * optionally with a crossfade. Allocate the delay line with the maximum delay you expect to avoid reallocations.
+ *
+ * Pass DelayLineMemoryLayout::mirrored if you want to read windows of the history directly from the delay memory,
+ * e.g. for vectorised crossfades or multi-tap reads, without having to deal with the wrap around.
+ *
+ * By default the channels are stored planar. One of the other DelayLineStorage policies can be passed as StoragePolicy
+ * for high channel counts, these specialisations only offer the frame based interface of push, back and processBlock.
  */
-template<typename SampleType>
+template<typename SampleType, typename StoragePolicy = DelayLineStorage::Planar>
 class MultichannelDelayLine
 {
 public:
-    explicit MultichannelDelayLine (int numSamples, int nChannels = 1)
-      : memory      (nChannels, numSamples),
-        indices     (size_t (nChannels), 0),
-        memoryPtr   (memory.getArrayOfWritePointers()),
-        length      (numSamples),
-        numChannels (nChannels)
+    static_assert (std::is_same<StoragePolicy, DelayLineStorage::Planar>::value, "Unknown storage policy");
+
+    explicit MultichannelDelayLine (int numSamples, int nChannels = 1, DelayLineMemoryLayout memoryLayout = DelayLineMemoryLayout::ring)
+      : memory        (nChannels, memoryLayout == DelayLineMemoryLayout::mirrored ? 2 * numSamples : numSamples),
+        indices       (size_t (nChannels), 0),
+        fadePositions (size_t (nChannels), 0),
+        memoryPtr     (memory.getArrayOfWritePointers()),
+        length        (numSamples),
+        numChannels   (nChannels),
+        isMirrored    (memoryLayout == DelayLineMemoryLayout::mirrored),
+        delay         (numSamples),
+        previousDelay (numSamples)
     {
+        // A delay line needs at least one sample of memory
+        jassert (numSamples > 0);
+
         memory.clear ();
     }
 
+    /**
+     * Changes the delay time to any value between 0 and the length the delay line was constructed with. This does not
+     * allocate and can be called while processing. If crossfadeLength is greater than zero, the next crossfadeLength
+     * samples processed by processBuffer or processBlock are crossfaded from the old to the new read position to avoid
+     * a click. A change during a running crossfade starts a new crossfade from the previous target. Samples pushed
+     * without being read count towards the crossfade as well, so it never outlasts crossfadeLength samples.
+     */
+    void setDelay (int newDelay, int crossfadeLength = 0) noexcept
+    {
+        // The delay time can't exceed the memory allocated
+        jassert (newDelay >= 0 && newDelay <= length);
+        newDelay = juce::jlimit (0, length, newDelay);
+
+        if (newDelay == delay)
+            return;
+
+        previousDelay = delay;
+        delay         = newDelay;
+        fadeLength    = std::max (0, crossfadeLength);
+
+        std::fill (fadePositions.begin(), fadePositions.end(), 0);
+    }
+
+    /** Returns the current delay time in samples */
+    int getDelay() const noexcept { return delay; }
+
     /** Pushes a new sample into the delay line. This will overwrite the oldest sample */
     void push (SampleType valueToPush, int channel) noexcept
     {
@@ -49,31 +136,83 @@ public:
 
         auto& idx = indices[c];
         memoryPtr[c][idx] = valueToPush;
-        --idx;
-        if (idx < 0) idx = 0;
+
+        if (isMirrored)
+            memoryPtr[c][idx + length] = valueToPush;
+
+        if (++idx == length)
+            idx = 0;
+
+        if (fadePositions[c] < fadeLength)
+            ++fadePositions[c];
     }
 
-    /** Returns the oldest sample in the delay line */
+    /**
+     * Returns the sample that was pushed delay samples before the sample that will be pushed next. Delay time
+     * crossfades are only applied to processBuffer and processBlock.
+     */
     SampleType back (int channel) const noexcept
     {
+        // The per-sample interface can't return a sample that has not been pushed yet
+        jassert (delay > 0);
+
         const auto c = static_cast<size_t> (channel);
 
-        return memoryPtr[c][indices[c]];
+        auto readIdx = indices[c] - delay;
+        if (readIdx < 0)
+            readIdx += length;
+
+        return memoryPtr[c][readIdx];
     }
 
     /**
      * Reads the src buffer and writes the delayed signal into the dest buffer. Both buffers must not point to the
      * same memory.
      */
-    void processBuffer (const SampleType* src, SampleType* dest, int bufferLength, int channel)
+    void processBuffer (const SampleType* src, SampleType* dest, int bufferLength, int channel) noexcept
     {
         jassert (src != dest);
 
-        for (int sample = 0; sample < bufferLength; ++sample)
+        const auto c = static_cast<size_t> (channel);
+        auto& fadePosition = fadePositions[c];
+
+        int numDone = 0;
+
+        // While the delay time changes, the signal at the previous and the new delay time is crossfaded chunk by chunk
+        while (fadePosition < fadeLength && numDone < bufferLength)
         {
-            dest[sample] = back (channel);
-            push (src[sample], channel);
+            const auto n = std::min ({ bufferLength - numDone, fadeLength - fadePosition, fadeChunkSize });
+
+            SampleType newDelayChunk[fadeChunkSize];
+
+            readDelayed (c, src, dest + numDone, numDone, n, previousDelay);
+            readDelayed (c, src, newDelayChunk,  numDone, n, delay);
+
+            for (int i = 0; i < n; ++i)
+            {
+                const auto gain = static_cast<SampleType> (fadePosition + i + 1) / static_cast<SampleType> (fadeLength);
+                dest[numDone + i] += gain * (newDelayChunk[i] - dest[numDone + i]);
+            }
+
+            numDone      += n;
+            fadePosition += n;
         }
+
+        readDelayed (c, src, dest + numDone, numDone, bufferLength - numDone, delay);
+
+        writeBuffer (src, bufferLength, c);
+    }
+
+    /**
+     * Pushes a whole buffer into the delay line without reading the delayed signal. This is useful in combination with
+     * getReadPointer, where the delayed signal is read directly from the delay memory.
+     */
+    void pushBuffer (const SampleType* src, int bufferLength, int channel) noexcept
+    {
+        const auto c = static_cast<size_t> (channel);
+
+        fadePositions[c] = std::min (fadeLength, fadePositions[c] + bufferLength);
+        writeBuffer (src, bufferLength, c);
     }
 
     /**
@@ -88,24 +227,437 @@ public:
 
         auto numSamples = static_cast<int> (srcBlock.getNumSamples ());
 
-        for (uint16_t channel = 0; channel < numChannels; ++channel)
-            processBuffer (srcBlock.getChannelPointer (channel), destBlock.getChannelPointer (channel), numSamples, channel);
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto c = static_cast<size_t> (channel);
+            processBuffer (srcBlock.getChannelPointer (c), destBlock.getChannelPointer (c), numSamples, channel);
+        }
     }
 
-    /** Clears the delay lines history */
+    /**
+     * Returns a pointer to the sample that was pushed numSamplesAgo samples ago, followed by all samples pushed after it
+     * in chronological order. The numSamplesAgo samples behind this pointer are contiguous memory and stay valid until
+     * the next write to the delay line. Only available for the mirrored memory layout.
+     */
+    const SampleType* getReadPointer (int channel, int numSamplesAgo) const noexcept
+    {
+        // Only a mirrored delay line can hand out contiguous windows into its history
+        jassert (isMirrored);
+        jassert (numSamplesAgo > 0 && numSamplesAgo <= length);
+
+        const auto c = static_cast<size_t> (channel);
+
+        return memoryPtr[c] + indices[c] + length - numSamplesAgo;
+    }
+
+    /** Clears the delay lines history and finishes a running delay time crossfade */
     void reset()
     {
         std::fill (indices.begin(), indices.end(), 0);
+        fadeLength = 0;
         memory.clear();
     }
 
+    /** Returns the length of the memory, which is the maximum delay time in samples */
+    int getLength() const noexcept { return length; }
+
+    int getNumChannels() const noexcept { return numChannels; }
+
+    DelayLineMemoryLayout getMemoryLayout() const noexcept
+    {
+        return isMirrored ? DelayLineMemoryLayout::mirrored : DelayLineMemoryLayout::ring;
+    }
+
 private:
+    static constexpr int fadeChunkSize = 64;
+
     juce::AudioBuffer<SampleType> memory;
     std::vector<int> indices;
+    std::vector<int> fadePositions;
 
     SampleType* const* memoryPtr;
     const int length;
     const int numChannels;
+    const bool isMirrored;
+
+    int delay;
+    int previousDelay;
+    int fadeLength = 0;
+
+    /**
+     * Writes numToRead samples of the current block, starting at firstSample and delayed by delayTime, into dest. The
+     * samples are either taken from the history or from the not yet pushed source buffer.
+     */
+    void readDelayed (size_t channel, const SampleType* src, SampleType* dest, int firstSample, int numToRead, int delayTime) const noexcept
+    {
+        const auto numFromHistory = juce::jlimit (0, numToRead, delayTime - firstSample);
+
+        if (numFromHistory > 0)
+        {
+            auto start = indices[channel] + firstSample - delayTime;
+            if (start < 0)
+                start += length;
+
+            readFromRing (memoryPtr[channel], start, dest, numFromHistory);
+        }
+
+        std::copy_n (src + firstSample + numFromHistory - delayTime, numToRead - numFromHistory, dest + numFromHistory);
+    }
+
+    /** Copies numToRead samples starting at start out of the ring, wrapping around at most once */
+    void readFromRing (const SampleType* ring, int start, SampleType* dest, int numToRead) const noexcept
+    {
+        // The mirrored copy behind the ring makes every read a single copy
+        if (isMirrored)
+        {
+            std::copy_n (ring + start, numToRead, dest);
+            return;
+        }
+
+        const auto numUntilWrap = std::min (numToRead, length - start);
+
+        std::copy_n (ring + start, numUntilWrap,             dest);
+        std::copy_n (ring,         numToRead - numUntilWrap, dest + numUntilWrap);
+    }
+
+    /** Writes a buffer into the ring of a channel and advances its write index */
+    void writeBuffer (const SampleType* src, int bufferLength, size_t c) noexcept
+    {
+        auto* ring = memoryPtr[c];
+        auto& idx  = indices[c];
+
+        if (bufferLength >= length)
+        {
+            // Only the end of the source has to be kept. Storing it at the ring start avoids a wrap for the next read.
+            writeToRing (ring, 0, src + bufferLength - length, length);
+            idx = 0;
+            return;
+        }
+
+        writeToRing (ring, idx, src, bufferLength);
+
+        idx += bufferLength;
+        if (idx >= length)
+            idx -= length;
+    }
+
+    /** Copies numToWrite samples into the ring starting at start, wrapping around at most once */
+    void writeToRing (SampleType* ring, int start, const SampleType* src, int numToWrite) const noexcept
+    {
+        const auto numUntilWrap = std::min (numToWrite, length - start);
+
+        std::copy_n (src,                numUntilWrap,              ring + start);
+        std::copy_n (src + numUntilWrap, numToWrite - numUntilWrap, ring);
+
+        if (isMirrored)
+        {
+            std::copy_n (src,                numUntilWrap,              ring + length + start);
+            std::copy_n (src + numUntilWrap, numToWrite - numUntilWrap, ring + length);
+        }
+    }
+};
+
+namespace detail
+{
+/**
+ * The implementation behind the interleaved and lane grouped storage policies. A groupSize of 0 means that all channels
+ * form a single group, which is the interleaved layout.
+ */
+template <typename SampleType, int groupSize>
+class GroupedStorageDelayLine
+{
+public:
+    GroupedStorageDelayLine (int numSamples, int nChannels)
+      : length      (numSamples),
+        numChannels (nChannels),
+        lanes       (groupSize > 0 ? groupSize : nChannels),
+        numGroups   ((nChannels + lanes - 1) / lanes),
+        memory      (static_cast<size_t> (numGroups * numSamples * lanes), SampleType (0)),
+        srcPtrs     (static_cast<size_t> (nChannels), nullptr),
+        destPtrs    (static_cast<size_t> (nChannels), nullptr)
+    {
+        // A delay line needs at least one sample of memory
+        jassert (numSamples > 0);
+    }
+
+    /** Pushes a new sample into the delay line. Call it for all channels before advancing to the next frame */
+    void push (SampleType valueToPush, int channel) noexcept
+    {
+        memory[sampleIndex (channel, idx)] = valueToPush;
+
+        if (channel == numChannels - 1 && ++idx == length)
+            idx = 0;
+    }
+
+    /** Returns the oldest sample in the delay line */
+    SampleType back (int channel) const noexcept
+    {
+        return memory[sampleIndex (channel, idx)];
+    }
+
+    /**
+     * Reads the source block and writes the delayed signal into the destination block. The block must have the number
+     * of channels and must not point to the same memory
+     */
+    void processBlock (const juce::dsp::AudioBlock<SampleType>& srcBlock, juce::dsp::AudioBlock<SampleType>& destBlock) noexcept
+    {
+        jassert (numChannels == static_cast<int> (srcBlock.getNumChannels()));
+        jassert (numChannels == static_cast<int> (destBlock.getNumChannels()));
+        jassert (srcBlock.getNumSamples() == destBlock.getNumSamples());
+
+        for (size_t c = 0; c < srcPtrs.size(); ++c)
+        {
+            srcPtrs[c]  = srcBlock .getChannelPointer (c);
+            destPtrs[c] = destBlock.getChannelPointer (c);
+        }
+
+        const auto numSamples = static_cast<int> (srcBlock.getNumSamples());
+
+        // Processes the block in segments that end at the wrap around of the ring
+        for (int done = 0; done < numSamples;)
+        {
+            const auto segmentLength = std::min (numSamples - done, length - idx);
+
+            for (int g = 0; g < numGroups; ++g)
+            {
+                const auto firstChannel = g * lanes;
+                const auto numGroupLanes = std::min (lanes, numChannels - firstChannel);
+
+                auto* frame = memory.data() + sampleIndex (firstChannel, idx);
+
+                // Wide groups are split into tiles with a compile time lane count, so that the lane loop is unrolled and
+                // the number of source and destination streams processed at once stays small
+                int l = 0;
+                for (; l + 8 <= numGroupLanes; l += 8) processTile<8> (frame + l, firstChannel + l, done, segmentLength);
+                for (; l + 4 <= numGroupLanes; l += 4) processTile<4> (frame + l, firstChannel + l, done, segmentLength);
+                for (; l < numGroupLanes; ++l)         processTile<1> (frame + l, firstChannel + l, done, segmentLength);
+            }
+
+            done += segmentLength;
+            idx += segmentLength;
+
+            if (idx == length)
+                idx = 0;
+        }
+    }
+
+    /** Clears the delay lines history */
+    void reset()
+    {
+        idx = 0;
+        std::fill (memory.begin(), memory.end(), SampleType (0));
+    }
+
+    /** Returns the delay in samples */
+    int getLength() const noexcept { return length; }
+
+    int getNumChannels() const noexcept { return numChannels; }
+
+private:
+    const int length;
+    const int numChannels;
+    const int lanes;
+    const int numGroups;
+
+    std::vector<SampleType> memory;
+    std::vector<const SampleType*> srcPtrs;
+    std::vector<SampleType*> destPtrs;
+
+    int idx = 0;
+
+    /** Exchanges numFrames frames of tileLanes consecutive channels between the history and the blocks */
+    template <int tileLanes>
+    void processTile (SampleType* frame, int firstChannel, int firstSample, int numFrames) noexcept
+    {
+        const SampleType* src[static_cast<size_t> (tileLanes)];
+        SampleType* dest[static_cast<size_t> (tileLanes)];
+
+        for (int l = 0; l < tileLanes; ++l)
+        {
+            src[l]  = srcPtrs [static_cast<size_t> (firstChannel + l)] + firstSample;
+            dest[l] = destPtrs[static_cast<size_t> (firstChannel + l)] + firstSample;
+        }
+
+        for (int i = 0; i < numFrames; ++i, frame += lanes)
+        {
+            for (int l = 0; l < tileLanes; ++l)
+            {
+                dest[l][i] = frame[l];
+                frame[l] = src[l][i];
+            }
+        }
+    }
+
+    size_t sampleIndex (int channel, int frame) const noexcept
+    {
+        const auto group = channel / lanes;
+        return static_cast<size_t> ((group * length + frame) * lanes + channel - group * lanes);
+    }
+};
+}
+
+/** A MultichannelDelayLine storing all channels of a frame next to each other */
+template <typename SampleType>
+class MultichannelDelayLine<SampleType, DelayLineStorage::Interleaved> : public detail::GroupedStorageDelayLine<SampleType, 0>
+{
+public:
+    explicit MultichannelDelayLine (int numSamples, int nChannels = 1)
+      : detail::GroupedStorageDelayLine<SampleType, 0> (numSamples, nChannels)
+    {}
+};
+
+/** A MultichannelDelayLine storing groups of groupSize channels interleaved */
+template <typename SampleType, int groupSize>
+class MultichannelDelayLine<SampleType, DelayLineStorage::LaneGrouped<groupSize>> : public detail::GroupedStorageDelayLine<SampleType, groupSize>
+{
+public:
+    explicit MultichannelDelayLine (int numSamples, int nChannels = 1)
+      : detail::GroupedStorageDelayLine<SampleType, groupSize> (numSamples, nChannels)
+    {}
+};
+
+/**
+ * A variant of MultichannelDelayLine with a delay length and a maximum number of channels known at compile time. The
+ * memory is stored inline and cache line aligned instead of on the heap, so it can be a direct member of a processor.
+ * Power of two lengths wrap the indices with a bit mask.
+ *
+ * Blocks passed to processBlock may have less channels than numChannels, the remaining channels are left untouched.
+ */
+template <typename SampleType, int length, int numChannels>
+class FixedMultichannelDelayLine
+{
+public:
+    static_assert (length > 0,      "A delay line needs at least one sample of memory");
+    static_assert (numChannels > 0, "A delay line needs at least one channel");
+
+    FixedMultichannelDelayLine()
+    {
+        reset();
+    }
+
+    /** Pushes a new sample into the delay line. This will overwrite the oldest sample */
+    void push (SampleType valueToPush, int channel) noexcept
+    {
+        const auto c = static_cast<size_t> (channel);
+
+        auto& idx = indices[c];
+        memory[c][idx] = valueToPush;
+        idx = wrap (idx + 1);
+    }
+
+    /** Returns the oldest sample in the delay line */
+    SampleType back (int channel) const noexcept
+    {
+        const auto c = static_cast<size_t> (channel);
+
+        return memory[c][indices[c]];
+    }
+
+    /**
+     * Reads the src buffer and writes the delayed signal into the dest buffer. Both buffers must not point to the
+     * same memory.
+     */
+    void processBuffer (const SampleType* src, SampleType* dest, int bufferLength, int channel) noexcept
+    {
+        jassert (src != dest);
+        jassert (channel < numChannels);
+
+        const auto c = static_cast<size_t> (channel);
+
+        const auto* ring = memory[c];
+        const auto idx   = indices[c];
+
+        // The oldest sample is read first, a block longer than the delay continues with the source itself
+        copyWrapped (ring + idx, ring, length - idx, dest, std::min (bufferLength, length));
+
+        if (bufferLength > length)
+            std::copy_n (src, bufferLength - length, dest + length);
+
+        pushBuffer (src, bufferLength, channel);
+    }
+
+    /** Pushes a whole buffer into the delay line without reading the delayed signal */
+    void pushBuffer (const SampleType* src, int bufferLength, int channel) noexcept
+    {
+        jassert (channel < numChannels);
+
+        const auto c = static_cast<size_t> (channel);
+
+        auto* ring = memory[c];
+        auto& idx  = indices[c];
+
+        if (bufferLength >= length)
+        {
+            std::copy_n (src + bufferLength - length, length, ring);
+            idx = 0;
+            return;
+        }
+
+        const auto numUntilWrap = std::min (bufferLength, length - idx);
+
+        std::copy_n (src,                numUntilWrap,                ring + idx);
+        std::copy_n (src + numUntilWrap, bufferLength - numUntilWrap, ring);
+
+        idx = wrap (idx + bufferLength);
+    }
+
+    /**
+     * Reads the source block and writes the delayed signal into the destination block. The blocks must have the same
+     * number of channels and must not point to the same memory. Channels beyond numChannels have no history to read
+     * from, they are cleared in the destination block.
+     */
+    void processBlock (const juce::dsp::AudioBlock<SampleType>& srcBlock, juce::dsp::AudioBlock<SampleType>& destBlock) noexcept
+    {
+        jassert (srcBlock.getNumChannels() <= static_cast<size_t> (numChannels));
+        jassert (srcBlock.getNumChannels() == destBlock.getNumChannels());
+        jassert (srcBlock.getNumSamples() == destBlock.getNumSamples());
+
+        auto numSamples = static_cast<int> (srcBlock.getNumSamples ());
+        auto numChannelsToProcess = std::min (srcBlock.getNumChannels(), static_cast<size_t> (numChannels));
+
+        for (size_t c = 0; c < numChannelsToProcess; ++c)
+            processBuffer (srcBlock.getChannelPointer (c), destBlock.getChannelPointer (c), numSamples, static_cast<int> (c));
+
+        for (auto c = numChannelsToProcess; c < destBlock.getNumChannels(); ++c)
+            std::fill_n (destBlock.getChannelPointer (c), numSamples, SampleType (0));
+    }
+
+    /** Clears the delay lines history */
+    void reset() noexcept
+    {
+        indices.fill (0);
+
+        for (auto& channel : memory)
+            std::fill (std::begin (channel), std::end (channel), SampleType (0));
+    }
+
+    /** Returns the delay in samples */
+    static constexpr int getLength() noexcept { return length; }
+
+    static constexpr int getNumChannels() noexcept { return numChannels; }
+
+private:
+    static constexpr bool hasPowerOfTwoLength = (length & (length - 1)) == 0;
+
+    alignas (64) SampleType memory[static_cast<size_t> (numChannels)][static_cast<size_t> (length)];
+    std::array<int, static_cast<size_t> (numChannels)> indices;
+
+    static constexpr int wrap (int idx) noexcept
+    {
+        if constexpr (hasPowerOfTwoLength)
+            return idx & (length - 1);
+        else
+            return idx >= length ? idx - length : idx;
+    }
+
+    /** Copies numToCopy samples from first and second, switching to second after numFromFirst samples */
+    static void copyWrapped (const SampleType* first, const SampleType* second, int numFromFirst, SampleType* dest, int numToCopy) noexcept
+    {
+        numFromFirst = std::min (numFromFirst, numToCopy);
+
+        std::copy_n (first,  numFromFirst,             dest);
+        std::copy_n (second, numToCopy - numFromFirst, dest + numFromFirst);
+    }
 };
 
 }
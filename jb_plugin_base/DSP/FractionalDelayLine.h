@@ -0,0 +1,258 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/** Tag types to choose the interpolation algorithm of a FractionalDelayLine */
+namespace DelayLineInterpolation
+{
+    /** Linear interpolation between the two neighbouring samples. Cheapest, but low-passes the delayed signal */
+    struct Linear {};
+
+    /** 3rd order Lagrange interpolation over four samples. Needs a delay of at least one sample */
+    struct Lagrange3rd {};
+
+    /**
+     * 1st order Thiran allpass interpolation. Flat magnitude response, but the recursive structure creates transients
+     * when the delay is modulated quickly, so it's best suited for slow modulation
+     */
+    struct Thiran {};
+}
+
+namespace detail
+{
+#if JUCE_USE_SIMD
+template <typename SampleType>
+using FractionalDelayRegister = juce::dsp::SIMDRegister<SampleType>;
+#else
+/**
+ * A single lane stand-in for juce::dsp::SIMDRegister on platforms where JUCE has no SIMD support. It only implements
+ * the operations the FractionalDelayLine needs, so that it falls back to processing one channel at a time.
+ */
+template <typename SampleType>
+struct ScalarRegister
+{
+    static constexpr size_t SIZE = 1;
+
+    static ScalarRegister expand (SampleType s) noexcept                 { return { s }; }
+    static ScalarRegister fromRawArray (const SampleType* a) noexcept    { return { a[0] }; }
+    void copyToRawArray (SampleType* a) const noexcept                   { a[0] = value; }
+
+    ScalarRegister operator+ (ScalarRegister other) const noexcept      { return { value + other.value }; }
+    ScalarRegister operator- (ScalarRegister other) const noexcept      { return { value - other.value }; }
+    ScalarRegister operator* (SampleType s) const noexcept              { return { value * s }; }
+
+    SampleType value;
+};
+
+template <typename SampleType>
+using FractionalDelayRegister = ScalarRegister<SampleType>;
+#endif
+}
+
+/**
+ * A delay line with a fractional delay time that can be modulated on a per-sample basis. All channels are delayed by
+ * the same amount which allows the interpolation to process multiple channels at once in a juce::dsp::SIMDRegister.
+ * Internally the channels are grouped into SIMD registers and each frame stores all groups next to each other. Without
+ * JUCE_USE_SIMD, each group holds a single channel.
+ *
+ * The memory is allocated once in the constructor, processing is allocation free. Source and destination block may
+ * point to the same memory.
+ */
+template <typename SampleType, typename Interpolator = DelayLineInterpolation::Linear>
+class FractionalDelayLine
+{
+public:
+    using Vector = detail::FractionalDelayRegister<SampleType>;
+
+    static constexpr int numLanes = static_cast<int> (Vector::SIZE);
+
+    FractionalDelayLine (int maximumDelayInSamples, int nChannels)
+      : maxDelay      (maximumDelayInSamples),
+        numChannels   (nChannels),
+        numGroups     ((nChannels + numLanes - 1) / numLanes),
+        bufferLength  (juce::nextPowerOfTwo (maximumDelayInSamples + numExtraSamples)),
+        mask          (bufferLength - 1),
+        memory        (static_cast<size_t> (bufferLength * numGroups), Vector::expand (SampleType (0))),
+        allpassStates (static_cast<size_t> (numGroups),                Vector::expand (SampleType (0)))
+    {
+        jassert (maximumDelayInSamples > 0);
+        jassert (nChannels > 0);
+    }
+
+    /**
+     * Delays the source block by the delay times passed in delayInSamples, which has to hold one value per sample.
+     * Delay times are clipped to the range supported by the interpolator and the maximum delay.
+     */
+    void processBlock (const juce::dsp::AudioBlock<SampleType>& srcBlock,
+                       juce::dsp::AudioBlock<SampleType>& destBlock,
+                       const SampleType* delayInSamples) noexcept
+    {
+        processInternal (srcBlock, destBlock, [delayInSamples] (size_t i) { return delayInSamples[i]; });
+    }
+
+    /** Delays the source block by a constant delay time */
+    void processBlock (const juce::dsp::AudioBlock<SampleType>& srcBlock,
+                       juce::dsp::AudioBlock<SampleType>& destBlock,
+                       SampleType delayInSamples) noexcept
+    {
+        processInternal (srcBlock, destBlock, [delayInSamples] (size_t) { return delayInSamples; });
+    }
+
+    /** Clears the delay lines history and the interpolator state */
+    void reset()
+    {
+        std::fill (memory.begin(),        memory.end(),        Vector::expand (SampleType (0)));
+        std::fill (allpassStates.begin(), allpassStates.end(), Vector::expand (SampleType (0)));
+        writeIndex = 0;
+    }
+
+    int getMaximumDelayInSamples() const noexcept { return maxDelay; }
+
+    int getNumChannels() const noexcept { return numChannels; }
+
+private:
+    static constexpr bool isLinear   = std::is_same<Interpolator, DelayLineInterpolation::Linear>::value;
+    static constexpr bool isLagrange = std::is_same<Interpolator, DelayLineInterpolation::Lagrange3rd>::value;
+    static constexpr bool isThiran   = std::is_same<Interpolator, DelayLineInterpolation::Thiran>::value;
+
+    static_assert (isLinear || isLagrange || isThiran, "Unknown interpolator type");
+
+    // The Lagrange interpolator reads up to two samples behind the integer delay
+    static constexpr int numExtraSamples = 3;
+
+    static constexpr SampleType minDelay = isLagrange ? SampleType (1) : SampleType (0);
+
+    const int maxDelay;
+    const int numChannels;
+    const int numGroups;
+    const int bufferLength;
+    const int mask;
+
+    std::vector<Vector> memory;
+    std::vector<Vector> allpassStates;
+    int writeIndex = 0;
+
+    /** Returns the register of the group that was written numSamplesAgo frames before the current write index */
+    const Vector& sampleAgo (int numSamplesAgo, int group) const noexcept
+    {
+        return memory[static_cast<size_t> (((writeIndex - numSamplesAgo) & mask) * numGroups + group)];
+    }
+
+    template <typename DelayForSample>
+    void processInternal (const juce::dsp::AudioBlock<SampleType>& srcBlock,
+                          juce::dsp::AudioBlock<SampleType>& destBlock,
+                          DelayForSample&& delayForSample) noexcept
+    {
+        jassert (numChannels == static_cast<int> (srcBlock.getNumChannels()));
+        jassert (numChannels == static_cast<int> (destBlock.getNumChannels()));
+        jassert (srcBlock.getNumSamples() == destBlock.getNumSamples());
+
+        alignas (Vector) SampleType lanes[Vector::SIZE] = {};
+
+        for (size_t i = 0; i < srcBlock.getNumSamples(); ++i)
+        {
+            const auto delay = juce::jlimit (minDelay, static_cast<SampleType> (maxDelay), delayForSample (i));
+
+            for (int g = 0; g < numGroups; ++g)
+            {
+                const auto firstChannel = g * numLanes;
+                const auto numGroupChannels = std::min (numLanes, numChannels - firstChannel);
+
+                for (int l = 0; l < numGroupChannels; ++l)
+                    lanes[l] = srcBlock.getChannelPointer (static_cast<size_t> (firstChannel + l))[i];
+
+                memory[static_cast<size_t> (writeIndex * numGroups + g)] = Vector::fromRawArray (lanes);
+
+                interpolate (delay, g).copyToRawArray (lanes);
+
+                for (int l = 0; l < numGroupChannels; ++l)
+                    destBlock.getChannelPointer (static_cast<size_t> (firstChannel + l))[i] = lanes[l];
+            }
+
+            writeIndex = (writeIndex + 1) & mask;
+        }
+    }
+
+    Vector interpolate (SampleType delay, int group) noexcept
+    {
+        auto delayInt = static_cast<int> (delay);
+        auto delayFrac = delay - static_cast<SampleType> (delayInt);
+
+        if constexpr (isLinear)
+        {
+            const auto& x0 = sampleAgo (delayInt,     group);
+            const auto& x1 = sampleAgo (delayInt + 1, group);
+
+            return x0 + (x1 - x0) * delayFrac;
+        }
+        else if constexpr (isLagrange)
+        {
+            // Interpolates at 1 + delayFrac between four samples, which is the range with the lowest error
+            delayInt -= 1;
+
+            const auto d1 = delayFrac - SampleType (1);
+            const auto d2 = delayFrac - SampleType (2);
+            const auto d3 = delayFrac + SampleType (1);
+
+            const auto h0 = -delayFrac * d1 * d2 / SampleType (6);
+            const auto h1 = d3 * d1 * d2 / SampleType (2);
+            const auto h2 = -d3 * delayFrac * d2 / SampleType (2);
+            const auto h3 = d3 * delayFrac * d1 / SampleType (6);
+
+            return sampleAgo (delayInt,     group) * h0
+                 + sampleAgo (delayInt + 1, group) * h1
+                 + sampleAgo (delayInt + 2, group) * h2
+                 + sampleAgo (delayInt + 3, group) * h3;
+        }
+        else
+        {
+            // Keeps the fractional part in the range where the allpass has the flattest group delay
+            if (delayFrac < SampleType (0.618) && delayInt >= 1)
+            {
+                delayFrac += SampleType (1);
+                delayInt -= 1;
+            }
+
+            auto& state = allpassStates[static_cast<size_t> (group)];
+            const auto& x0 = sampleAgo (delayInt, group);
+
+            if (juce::exactlyEqual (delayFrac, SampleType (0)))
+            {
+                state = x0;
+                return state;
+            }
+
+            const auto alpha = (SampleType (1) - delayFrac) / (SampleType (1) + delayFrac);
+
+            state = sampleAgo (delayInt + 1, group) + (x0 - state) * alpha;
+            return state;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FractionalDelayLine)
+};
+
+}
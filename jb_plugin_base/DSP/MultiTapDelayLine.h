@@ -0,0 +1,161 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/**
+ * A delay line that sums an arbitrary number of taps with individual delay times and gains into its output. Use it to
+ * build tapped delay reverbs or early reflection generators.
+ *
+ * If the destination block has as many channels as the source block, each channel is delayed by all taps individually
+ * and the tap pan value is ignored. If a mono source is processed into a stereo destination, each tap is panned by a
+ * constant power pan law, where -1 is hard left and 1 is hard right.
+ *
+ * The history is kept in a mirrored MultichannelDelayLine, so every tap reads a contiguous span of memory. Blocks are
+ * processed in chunks of chunkSize samples and all taps are summed into a chunk before the next one starts, so that
+ * the output chunk and the read spans of neighbouring taps stay in the cache.
+ */
+template <typename SampleType>
+class MultiTapDelayLine
+{
+public:
+    struct Tap
+    {
+        int        delayInSamples = 0;
+        SampleType gain           = SampleType (1);
+        SampleType pan            = SampleType (0);
+    };
+
+    static constexpr int chunkSize = 64;
+
+    MultiTapDelayLine (int maximumDelayInSamples, int nChannels)
+      : delayLine (maximumDelayInSamples + chunkSize, nChannels, DelayLineMemoryLayout::mirrored),
+        maxDelay  (maximumDelayInSamples)
+    {
+        jassert (maximumDelayInSamples >= 0);
+    }
+
+    /**
+     * Replaces the tap table. Delay times are clipped to the maximum delay. This allocates if the number of taps
+     * exceeds the number of taps set previously, so make sure to set the largest table before processing starts if
+     * you want to change the taps from the audio thread.
+     */
+    void setTaps (const std::vector<Tap>& newTaps)
+    {
+        taps.clear();
+
+        for (const auto& t : newTaps)
+        {
+            const auto angle = (juce::jlimit (SampleType (-1), SampleType (1), t.pan) + SampleType (1)) * juce::MathConstants<SampleType>::pi / SampleType (4);
+
+            taps.push_back ({ juce::jlimit (0, maxDelay, t.delayInSamples),
+                              t.gain,
+                              t.gain * std::cos (angle),
+                              t.gain * std::sin (angle) });
+        }
+
+        // Taps reading neighbouring regions of the history are processed one after another
+        std::sort (taps.begin(), taps.end(), [] (const InternalTap& a, const InternalTap& b) { return a.delayInSamples < b.delayInSamples; });
+    }
+
+    /**
+     * Pushes the source block into the delay line and writes the sum of all taps into the destination block. The
+     * destination must either have the same number of channels as the source or two channels for a mono source. Source
+     * and destination may point to the same memory.
+     */
+    void processBlock (const juce::dsp::AudioBlock<SampleType>& srcBlock, juce::dsp::AudioBlock<SampleType>& destBlock) noexcept
+    {
+        const auto numSrcChannels  = static_cast<int> (srcBlock.getNumChannels());
+        const auto numDestChannels = static_cast<int> (destBlock.getNumChannels());
+        const auto isPanning = numSrcChannels == 1 && numDestChannels == 2;
+
+        jassert (numSrcChannels == delayLine.getNumChannels());
+        jassert (numSrcChannels == numDestChannels || isPanning);
+        jassert (srcBlock.getNumSamples() == destBlock.getNumSamples());
+
+        const auto numSamples = static_cast<int> (srcBlock.getNumSamples());
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const auto n = std::min (chunkSize, numSamples - start);
+            const auto s = static_cast<size_t> (start);
+
+            // The chunk is pushed first, so that writing the output cannot overwrite unread input when processing in place
+            for (int c = 0; c < numSrcChannels; ++c)
+                delayLine.pushBuffer (srcBlock.getChannelPointer (static_cast<size_t> (c)) + s, n, c);
+
+            if (isPanning)
+            {
+                sumTaps (destBlock.getChannelPointer (0) + s, n, 0, &InternalTap::gainLeft);
+                sumTaps (destBlock.getChannelPointer (1) + s, n, 0, &InternalTap::gainRight);
+            }
+            else
+            {
+                for (int c = 0; c < numDestChannels; ++c)
+                    sumTaps (destBlock.getChannelPointer (static_cast<size_t> (c)) + s, n, c, &InternalTap::gain);
+            }
+        }
+    }
+
+    /** Clears the delay lines history */
+    void reset()
+    {
+        delayLine.reset();
+    }
+
+    int getMaximumDelayInSamples() const noexcept { return maxDelay; }
+
+private:
+    struct InternalTap
+    {
+        int        delayInSamples;
+        SampleType gain, gainLeft, gainRight;
+    };
+
+    MultichannelDelayLine<SampleType> delayLine;
+    std::vector<InternalTap> taps;
+    const int maxDelay;
+
+    void sumTaps (SampleType* dest, int numSamples, int channel, SampleType InternalTap::* gain) const noexcept
+    {
+        if (taps.empty())
+        {
+            juce::FloatVectorOperations::clear (dest, numSamples);
+            return;
+        }
+
+        // The sample at dest[0] was pushed numSamples ago, so a tap delayed by d starts numSamples + d samples ago
+        auto readPtr = [&] (const InternalTap& t) { return delayLine.getReadPointer (channel, numSamples + t.delayInSamples); };
+
+        juce::FloatVectorOperations::copyWithMultiply (dest, readPtr (taps.front()), taps.front().*gain, numSamples);
+
+        for (auto t = std::next (taps.begin()); t != taps.end(); ++t)
+            juce::FloatVectorOperations::addWithMultiply (dest, readPtr (*t), (*t).*gain, numSamples);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiTapDelayLine)
+};
+
+}
@@ -119,6 +119,8 @@ private:
 
     void resized() override
     {
+        JB_TRACE_SCOPE ("PluginEditorBase::resized");
+
         checkComponentBounds (this);
 
         constrainedResized();
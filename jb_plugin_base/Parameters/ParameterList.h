@@ -0,0 +1,274 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/** The range of a float or int parameter in a compile time parameter description, see ParameterList */
+template <typename ValueType>
+struct ParameterRange
+{
+    ValueType minValue;
+    ValueType maxValue;
+
+    /** Step size and skew factor, both only used for float parameters */
+    ValueType interval = 0;
+    float     skew     = 1.0f;
+};
+
+namespace detail
+{
+    template <class Param>
+    using ParameterValueType = std::remove_cv_t<decltype (Param::defaultValue)>;
+
+    template <class Param>
+    std::unique_ptr<juce::RangedAudioParameter> createParameter()
+    {
+        using ValueType = ParameterValueType<Param>;
+
+        if constexpr (std::is_same_v<ValueType, bool>)
+        {
+            return std::make_unique<juce::AudioParameterBool> (Param::id, Param::name, Param::defaultValue);
+        }
+        else if constexpr (std::is_same_v<ValueType, int>)
+        {
+            return std::make_unique<juce::AudioParameterInt> (Param::id, Param::name, Param::range.minValue, Param::range.maxValue, Param::defaultValue);
+        }
+        else
+        {
+            static_assert (std::is_same_v<ValueType, float>, "The defaultValue of a parameter description must be a float, int or bool");
+
+            const juce::NormalisableRange<float> range (Param::range.minValue, Param::range.maxValue, Param::range.interval, Param::range.skew);
+            return std::make_unique<juce::AudioParameterFloat> (Param::id, Param::name, range, Param::defaultValue);
+        }
+    }
+
+    /** Returns the position of Param in Params or the number of Params if it is not one of them */
+    template <class Param, class... Params>
+    constexpr size_t indexOfParameter()
+    {
+        constexpr bool matches[] = { false, std::is_same_v<Param, Params>... };
+
+        for (size_t i = 1; i < sizeof (matches); ++i)
+            if (matches[i])
+                return i - 1;
+
+        return sizeof... (Params);
+    }
+}
+
+/**
+ * A compile time description of the parameters of a plugin. Each parameter is described by a struct with the static
+ * constexpr members id, name and defaultValue. The type of defaultValue determines the parameter type: float creates an
+ * AudioParameterFloat and int an AudioParameterInt, both need an additional ParameterRange range. bool creates an
+ * AudioParameterBool.
+ *
+ * Put the list as a type alias named Parameters into your ParameterProvider, to let PluginAudioProcessorBase take a
+ * Snapshot of all parameter values at the start of each block. Reading parameters in processBlock is then a plain load
+ * from a small struct instead of an atomic load through a pointer looked up by a string id. The snapshot also tells which
+ * parameters changed since the last block, so that dependent coefficients only need to be recomputed when necessary.
+ *
+ * @code
+ * struct MyPluginParameters
+ * {
+ *     struct Gain
+ *     {
+ *         static constexpr auto id           = "gain";
+ *         static constexpr auto name         = "Gain";
+ *         static constexpr auto range        = jb::ParameterRange<float> { -24.0f, 24.0f };
+ *         static constexpr auto defaultValue = 0.0f;
+ *     };
+ *
+ *     struct Bypass
+ *     {
+ *         static constexpr auto id           = "bypass";
+ *         static constexpr auto name         = "Bypass";
+ *         static constexpr auto defaultValue = false;
+ *     };
+ *
+ *     using Parameters = jb::ParameterList<Gain, Bypass>;
+ *
+ *     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() { return Parameters::createParameterLayout(); }
+ *     static juce::StringArray getPresetManagerParameters()                               { return { Gain::id }; }
+ * };
+ *
+ * // In processBlock
+ * if (hasParameterChanged<MyPluginParameters::Gain>())
+ *     gain.setGainDecibels (getParameterValue<MyPluginParameters::Gain>());
+ * @endcode
+ */
+template <class... Params>
+struct ParameterList
+{
+    static constexpr size_t size = sizeof... (Params);
+
+    /** The position of Param in this list, which is also its position in a Snapshot */
+    template <class Param>
+    static constexpr size_t indexOf = detail::indexOfParameter<Param, Params...>();
+
+    template <class Param>
+    static constexpr bool contains = indexOf<Param> < size;
+
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout()
+    {
+        juce::AudioProcessorValueTreeState::ParameterLayout layout;
+        (layout.add (detail::createParameter<Params>()), ...);
+        return layout;
+    }
+
+    static juce::StringArray getIds()
+    {
+        return { Params::id... };
+    }
+
+    /** The number of 64 bit words needed for one change flag per parameter */
+    static constexpr size_t numChangeWords = (size + 63) / 64;
+
+    /**
+     * The raw values of all parameters at one point in time, in the order of the list, and a flag per parameter that
+     * tells if it changed since the flags were last cleared
+     */
+    struct Snapshot
+    {
+        std::array<float, size>              values;
+        std::array<uint64_t, numChangeWords> changed;
+
+        /** Returns the value of Param converted to the type of its defaultValue */
+        template <class Param>
+        auto get() const noexcept
+        {
+            static_assert (contains<Param>, "This parameter is not part of the ParameterList");
+
+            const auto value = values[indexOf<Param>];
+
+            if constexpr (std::is_same_v<detail::ParameterValueType<Param>, bool>)
+                return value >= 0.5f;
+            else if constexpr (std::is_same_v<detail::ParameterValueType<Param>, int>)
+                return juce::roundToInt (value);
+            else
+                return value;
+        }
+
+        /** Returns true if Param changed since the change flags were last cleared */
+        template <class Param>
+        bool hasChanged() const noexcept
+        {
+            static_assert (contains<Param>, "This parameter is not part of the ParameterList");
+            return hasChanged (indexOf<Param>);
+        }
+
+        bool hasChanged (size_t index) const noexcept
+        {
+            jassert (index < size);
+            return ((changed[index / 64] >> (index % 64)) & 1) != 0;
+        }
+
+        bool anyChanged() const noexcept
+        {
+            return std::any_of (changed.begin(), changed.end(), [] (uint64_t word) { return word != 0; });
+        }
+
+        void clearChanges() noexcept
+        {
+            changed.fill (0);
+        }
+    };
+
+    /**
+     * Caches the raw value pointers of all parameters in a tree state to take snapshots from them. It also listens to the
+     * parameters and sets an atomic change flag per parameter, which is moved into the next snapshot. The parameter
+     * listener callbacks come with the processor's parameter index, which is mapped to the list index through a table,
+     * so no string comparison is involved.
+     */
+    class SnapshotSource : private juce::AudioProcessorParameter::Listener
+    {
+    public:
+        explicit SnapshotSource (juce::AudioProcessorValueTreeState& state)
+          : parameters { state.getParameter (Params::id)... },
+            rawValues  { state.getRawParameterValue (Params::id)... }
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                // All parameters of the list have to be part of the tree state
+                jassert (parameters[i] != nullptr && rawValues[i] != nullptr);
+
+                const auto processorIndex = static_cast<size_t> (parameters[i]->getParameterIndex());
+
+                if (processorIndex >= listIndices.size())
+                    listIndices.resize (processorIndex + 1, size);
+
+                listIndices[processorIndex] = i;
+                parameters[i]->addListener (this);
+
+                // Everything counts as changed for the first block
+                markChanged (i);
+            }
+        }
+
+        ~SnapshotSource() override
+        {
+            for (auto* p : parameters)
+                p->removeListener (this);
+        }
+
+        /** Adds the changes since the last update to the snapshot's change flags and copies the current values */
+        void update (Snapshot& snapshot) noexcept
+        {
+            // The flags are taken before the values, so that a change in between is reported again with the next update
+            // rather than getting lost
+            for (size_t w = 0; w < numChangeWords; ++w)
+                snapshot.changed[w] |= changeFlags[w].exchange (0, std::memory_order_acquire);
+
+            for (size_t i = 0; i < size; ++i)
+                snapshot.values[i] = rawValues[i]->load (std::memory_order_relaxed);
+        }
+
+    private:
+        const std::array<juce::RangedAudioParameter*, size> parameters;
+        const std::array<std::atomic<float>*, size>         rawValues;
+
+        /** The list index for each processor parameter index, size for parameters that are not part of the list */
+        std::vector<size_t> listIndices;
+
+        std::array<std::atomic<uint64_t>, numChangeWords> changeFlags {};
+
+        void markChanged (size_t index) noexcept
+        {
+            if (index < size)
+                changeFlags[index / 64].fetch_or (uint64_t (1) << (index % 64), std::memory_order_release);
+        }
+
+        void parameterValueChanged (int parameterIndex, float) override
+        {
+            if (parameterIndex >= 0 && static_cast<size_t> (parameterIndex) < listIndices.size())
+                markChanged (listIndices[static_cast<size_t> (parameterIndex)]);
+        }
+
+        void parameterGestureChanged (int, bool) override {}
+
+        JUCE_DECLARE_NON_COPYABLE (SnapshotSource)
+    };
+};
+
+}
@@ -58,6 +58,8 @@ std::unique_ptr<PresetManagerComponent> StateAndPresetManager::createPresetManag
 
 bool StateAndPresetManager::loadPreset (const juce::String& presetName)
 {
+    JB_TRACE_SCOPE ("StateAndPresetManager::loadPreset");
+
     juce::ScopedLock localScopedLock (localResourcesLock);
 
     auto presetFile = findPresetFile (presetName);
@@ -78,6 +80,8 @@ bool StateAndPresetManager::loadPreset (const juce::String& presetName)
 
 void StateAndPresetManager::storePreset (const juce::String& presetName, bool skipIfPresetWithThisNameExists)
 {
+    JB_TRACE_SCOPE ("StateAndPresetManager::storePreset");
+
     juce::ScopedLock localScopedLock (localResourcesLock);
 
     if (currentPresetWasModified)
@@ -164,6 +168,8 @@ juce::StringArray StateAndPresetManager::getPresetList()
 
 void StateAndPresetManager::getStateInformation (juce::MemoryBlock& destData)
 {
+    JB_TRACE_SCOPE ("StateAndPresetManager::getStateInformation");
+
     parametersLock.enter();
     auto state = parameters.copyState();
     parametersLock.exit();
@@ -210,12 +216,19 @@ void StateAndPresetManager::modifiedCurrentPreset ()
         presetManagerComponent->modifiedCurrentPreset();
 }
 
-const File StateAndPresetManager::presetDirectory = File::getSpecialLocation (File::SpecialLocationType::userApplicationDataDirectory)
-                                                    #if JUCE_MAC
-                                                    .getChildFile ("Audio/Presets")
-                                                    #endif
-                                                    .getChildFile (JucePlugin_Manufacturer)
-                                                    .getChildFile (JucePlugin_Name);
+void StateAndPresetManager::setPresetDirectoryForTesting (const File& directory)
+{
+    presetDirectoryStorage = directory;
+}
+
+File StateAndPresetManager::presetDirectoryStorage = File::getSpecialLocation (File::SpecialLocationType::userApplicationDataDirectory)
+                                                     #if JUCE_MAC
+                                                     .getChildFile ("Audio/Presets")
+                                                     #endif
+                                                     .getChildFile (JucePlugin_Manufacturer)
+                                                     .getChildFile (JucePlugin_Name);
+
+const File& StateAndPresetManager::presetDirectory = presetDirectoryStorage;
 
 const juce::Identifier              StateAndPresetManager::presetNameID ("PresetName");
 juce::Array<juce::File>             StateAndPresetManager::presetFilesAvailable;
@@ -45,13 +45,25 @@ public:
     void getStateInformation (juce::MemoryBlock& destData);
     void setStateInformation (const void* data, int sizeInBytes);
 
-    static const juce::File presetDirectory;
+    /**
+     * The directory that holds the presets and the settings file, a directory named after the plugin in the user
+     * application data directory.
+     */
+    static const juce::File& presetDirectory;
+
+    /**
+     * Redirects presetDirectory, so that tests and benchmarks don't touch the user's presets and settings. Call it before
+     * the first StateAndPresetManager or the SettingsManager is created. Plugins should never call this.
+     */
+    static void setPresetDirectoryForTesting (const juce::File& directory);
 private:
     friend class PresetManagerComponent;
 
     template <class ParameterProvider>
     friend class PluginAudioProcessorBase;
 
+    static juce::File presetDirectoryStorage;
+
     static const juce::Identifier presetNameID;
 
     static juce::Array<juce::File>             presetFilesAvailable;
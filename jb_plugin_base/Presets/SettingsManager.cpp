@@ -25,11 +25,12 @@
 namespace jb
 {
 
-    const juce::File SettingsManager::settingsFile (StateAndPresetManager::presetDirectory.getChildFile ("Settings.json"));
-    const std::string SettingsManager::settingsFileFullPath (settingsFile.getFullPathName().toStdString());
-
     SettingsManager::SettingsManager()
+      : settingsFile         (StateAndPresetManager::presetDirectory.getChildFile ("Settings.json")),
+        settingsFileFullPath (settingsFile.getFullPathName().toStdString())
     {
+        JB_TRACE_SCOPE ("SettingsManager::load");
+
         if (!settingsFile.existsAsFile())
         {
             auto result = settingsFile.create();
@@ -66,6 +67,8 @@ namespace jb
     {
         if (settingsWereWritten)
         {
+            JB_TRACE_SCOPE ("SettingsManager::save");
+
             // Open in truncate mode to clear the file before writing new content
             std::ofstream settingsFileStream (settingsFileFullPath, std::ios::trunc);
 
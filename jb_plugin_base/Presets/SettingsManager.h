@@ -48,8 +48,8 @@ public:
 
     JUCE_DECLARE_SINGLETON (SettingsManager, false)
 private:
-    static const juce::File settingsFile;
-    static const std::string settingsFileFullPath;
+    const juce::File settingsFile;
+    const std::string settingsFileFullPath;
 
     nlohmann::json settings;
     bool settingsWereWritten = false;
@@ -25,6 +25,166 @@ SOFTWARE.
 namespace jb
 {
 
+namespace detail
+{
+    template <class ParameterProvider, typename = void>
+    struct HasFixedLatency : std::false_type {};
+
+    template <class ParameterProvider>
+    struct HasFixedLatency<ParameterProvider, std::void_t<decltype (ParameterProvider::FixedLatency::numSamples)>> : std::true_type {};
+
+    template <class ParameterProvider, typename = void>
+    struct HasParameterList : std::false_type {};
+
+    template <class ParameterProvider>
+    struct HasParameterList<ParameterProvider, std::void_t<typename ParameterProvider::Parameters::Snapshot>> : std::true_type {};
+
+    /** Placeholder for the parameter snapshot of processors without a ParameterList */
+    struct NoParameterSnapshot
+    {
+        explicit NoParameterSnapshot (juce::AudioProcessorValueTreeState&) {}
+
+        void update() noexcept {}
+        void clearChanges() noexcept {}
+    };
+
+    /** The parameter values of the current block and the pointers to the raw values they are taken from */
+    template <class ParameterList>
+    struct ParameterSnapshot
+    {
+        explicit ParameterSnapshot (juce::AudioProcessorValueTreeState& state)
+          : source (state)
+        {
+            update();
+        }
+
+        void update() noexcept
+        {
+            source.update (snapshot);
+        }
+
+        void clearChanges() noexcept
+        {
+            snapshot.clearChanges();
+        }
+
+        typename ParameterList::SnapshotSource source;
+        typename ParameterList::Snapshot       snapshot {};
+    };
+
+    template <class ParameterProvider, bool hasParameterList = HasParameterList<ParameterProvider>::value>
+    struct ParameterSnapshotType
+    {
+        using Type = NoParameterSnapshot;
+    };
+
+    template <class ParameterProvider>
+    struct ParameterSnapshotType<ParameterProvider, true>
+    {
+        using Type = ParameterSnapshot<typename ParameterProvider::Parameters>;
+    };
+
+    /** Placeholder for the fixed bypass delay line of processors without a fixed latency */
+    struct NoFixedDelayLine {};
+
+    template <class ParameterProvider, typename SampleType, bool hasFixedLatency = HasFixedLatency<ParameterProvider>::value>
+    struct FixedBypassDelayLine
+    {
+        using Type = NoFixedDelayLine;
+    };
+
+    template <class ParameterProvider, typename SampleType>
+    struct FixedBypassDelayLine<ParameterProvider, SampleType, true>
+    {
+        using Type = FixedMultichannelDelayLine<SampleType,
+                                                ParameterProvider::FixedLatency::numSamples,
+                                                ParameterProvider::FixedLatency::maxNumChannels>;
+    };
+
+    /**
+     * Collects arbitrarily sized blocks into frames of a fixed size. Two frame buffers are used alternately: one is filled
+     * with the incoming samples while the other one, which holds the last processed frame, is read out. When a frame is
+     * complete, it is processed in place and the roles of the buffers are swapped, so no frame is ever copied. This adds
+     * a latency of exactly one frame.
+     */
+    template <typename SampleType>
+    class FrameFifo
+    {
+    public:
+        /** Allocates the frames, don't call this from the audio thread */
+        void prepare (int numChannels, int frameSize)
+        {
+            for (auto& f : frames)
+                f.setSize (numChannels, frameSize);
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& f : frames)
+                f.clear();
+
+            position = 0;
+        }
+
+        /** Pushes the block into the fifo and replaces it with the output delayed by one frame */
+        template <typename FrameProcessor>
+        void process (const juce::dsp::AudioBlock<SampleType>& block, FrameProcessor&& processFrame)
+        {
+            auto* inputFrame  = &frames[inputIndex];
+            auto* outputFrame = &frames[1 - inputIndex];
+
+            const auto frameSize  = inputFrame->getNumSamples();
+            const auto numSamples = static_cast<int> (block.getNumSamples());
+            const auto numChannels = std::min (static_cast<int> (block.getNumChannels()), inputFrame->getNumChannels());
+
+            jassert (frameSize > 0);
+
+            for (int done = 0; done < numSamples;)
+            {
+                const auto n = std::min (numSamples - done, frameSize - position);
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    auto* inOut = block.getChannelPointer (static_cast<size_t> (c)) + done;
+
+                    std::copy_n (inOut, n, inputFrame->getWritePointer (c) + position);
+                    std::copy_n (outputFrame->getReadPointer (c) + position, n, inOut);
+                }
+
+                done += n;
+                position += n;
+
+                if (position == frameSize)
+                {
+                    juce::dsp::AudioBlock<SampleType> frame (*inputFrame);
+                    processFrame (frame);
+
+                    inputIndex = 1 - inputIndex;
+                    std::swap (inputFrame, outputFrame);
+                    position = 0;
+                }
+            }
+        }
+
+    private:
+        std::array<juce::AudioBuffer<SampleType>, 2> frames;
+        int inputIndex = 0;
+        int position = 0;
+    };
+}
+
+/** The filter designs PluginAudioProcessorBase can use for oversampling, see juce::dsp::Oversampling for details */
+enum class OversamplingFilter
+{
+    /** Minimum phase polyphase IIR half band filters, low latency and cpu load */
+    polyphaseIIR,
+
+    /** Linear phase equiripple FIR half band filters, no phase distortion but more latency */
+    linearPhaseFIR
+};
+
 /**
  * You need to pass in a class containing two static functions:
  * - juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() which returns the
@@ -35,6 +195,11 @@ namespace jb
  * Furthermore it has to contain the netsted struct "Bypass", containing a static "id" string to identify
  * the parameter ID of the bypass parameter to be exposed to the host.
  *
+ * If the latency of your processor is known at compile time, e.g. because of a fixed FIR or lookahead length, you can
+ * add an optional nested struct "FixedLatency" containing a static constexpr int "numSamples" and a static constexpr int
+ * "maxNumChannels". The base will then report that latency to the host and use a FixedMultichannelDelayLine for the
+ * bypass, which lives inline in the processor instead of being allocated on the heap.
+ *
  * Example:
  *
  * @code
@@ -58,6 +223,13 @@ namespace jb
  *     {
  *         return { "a", "b" };
  *     }
+ *
+ *     // Optional
+ *     struct FixedLatency
+ *     {
+ *         static constexpr int numSamples = 64;
+ *         static constexpr int maxNumChannels = 2;
+ *     };
  * }
  *   @endcode
  *
@@ -71,10 +243,15 @@ public:
      : AudioProcessor        (createBusLayout()),
        parameters            (*this, &undoManager, getAPVTSType(), ParameterProvider::createParameterLayout()),
        stateAndPresetManager (*this, parameters, ParameterProvider::getPresetManagerParameters(), undoManager),
-       bypassParameter       (parameters.getParameter (ParameterProvider::Bypass::id))
+       parameterSnapshot     (parameters),
+       bypassParameter       (parameters.getParameter (ParameterProvider::Bypass::id)),
+       bypassParameterValue  (parameters.getRawParameterValue (ParameterProvider::Bypass::id))
     {
         // The bypass parameter id in your ParameterProvider class is not valid
-        jassert (bypassParameter != nullptr);
+        jassert (bypassParameter != nullptr && bypassParameterValue != nullptr);
+
+        if constexpr (hasFixedLatency)
+            setLatencySamples (ParameterProvider::FixedLatency::numSamples);
     }
 
     /** An initialization call that will concatenate prepareToPlay and numChannelsChanged */
@@ -82,8 +259,39 @@ public:
     virtual void processBlock (juce::dsp::AudioBlock<float>& block) = 0;
 
     /**
-     * The audio processor has a processBlock overload with double buffers. This declaration silences shadowing warnings
-     * and allows us to still override the double version if we want to.
+     * Override this together with supportsDoublePrecisionProcessing to process in double precision if the host offers
+     * it. The bypass delay line and crossfade will then run in double precision as well, so no conversion takes place.
+     */
+    virtual void processBlock (juce::dsp::AudioBlock<double>&)
+    {
+        // You have to override this if supportsDoublePrecisionProcessing returns true
+        jassertfalse;
+    }
+
+    /** Override this and return true if you implemented the double precision processBlock */
+    bool supportsDoublePrecisionProcessing() const override { return false; }
+
+    /**
+     * If channel parallel processing is enabled via setChannelParallelProcessing, this is called instead of processBlock
+     * once for each channel, possibly from several threads at the same time. The block passed in contains only the
+     * channel with the index channelIdx, so your processing must not depend on other channels.
+     */
+    virtual void processChannel (juce::dsp::AudioBlock<float>&, int /* channelIdx */)
+    {
+        // You have to override this if you enable channel parallel processing
+        jassertfalse;
+    }
+
+    /** The double precision version of processChannel */
+    virtual void processChannel (juce::dsp::AudioBlock<double>&, int /* channelIdx */)
+    {
+        // You have to override this if you enable channel parallel processing in double precision
+        jassertfalse;
+    }
+
+    /**
+     * The audio processor has processBlock overloads with buffers. This declaration silences shadowing warnings
+     * and makes them accessible through the base class.
      */
     using AudioProcessor::processBlock;
 
@@ -115,9 +323,228 @@ public:
                                 .withOutput ("Output", juce::AudioChannelSet::mono(), true);
     }
 
-    double getSampleRate()         { return currentSampleRate; }
+    /**
+     * Declares the highest latency your processor will ever report via setLatencySamples, not including the latency
+     * added by a required frame size. The bypass delay line is allocated with this length, so that latency changes while
+     * processing, e.g. when switching a lookahead setting, only move its read position with a short crossfade instead of
+     * reallocating it. Call this in your constructor.
+     */
+    void setMaximumLatencySamples (int maxLatencyInSamples)
+    {
+        jassert (maxLatencyInSamples >= 0);
+        maximumLatencySamples = maxLatencyInSamples;
+    }
+
+    /**
+     * Reports a new latency to the host, just like juce::AudioProcessor::setLatencySamples. The value is mirrored for
+     * the audio thread, which follows latency changes with the bypass delay line, so always call this version and not
+     * the one of the juce::AudioProcessor base class.
+     */
+    void setLatencySamples (int newLatency)
+    {
+        latencySamples.store (newLatency);
+        juce::AudioProcessor::setLatencySamples (newLatency);
+    }
+
+    /**
+     * Sets the duration of the fade between the processed and the bypassed signal. The fade may span several blocks,
+     * so it is independent of the host buffer size. Takes effect on the next prepareToPlay call.
+     *
+     * The bypass parameter is read once per host block, so a fade starts at the beginning of the host block in which the
+     * change arrived. The JUCE plugin wrappers apply parameter changes before processBlock is called and don't expose the
+     * sample position of automation points, so this is the finest resolution available.
+     */
+    void setBypassFadeLength (double milliseconds)
+    {
+        jassert (milliseconds > 0.0);
+        bypassFadeLengthMs = milliseconds;
+    }
+
+    /**
+     * Enables a fixed internal block size. Host buffers are then cut into blocks of this size before your processBlock
+     * is called, only the last block of a host buffer may be shorter if the host buffer size is no multiple of it.
+     * prepareResources and createProcessSpec will report this size as maximum block size, so scratch memory can be sized
+     * exactly and control rate updates happen at a predictable rate. Pass 0 to process host buffers as they come, which
+     * is the default. Call this in your constructor.
+     *
+     * Regardless of this setting, host buffers that are longer than the size announced in prepareToPlay are split, so
+     * that no memory has to be resized on the audio thread.
+     */
+    void setInternalBlockSize (int numSamples)
+    {
+        jassert (numSamples >= 0);
+        internalBlockSize = numSamples;
+    }
+
+    /**
+     * Enables the frame mode for processors that need a fixed number of samples per call, e.g. an FFT size. Host
+     * buffers are then collected into frames of exactly this size by a double buffered fifo before your processBlock is
+     * called. The fifo adds a latency of one frame, which is reported to the host and used for the bypass delay line.
+     * Pass 0 to disable it, which is the default. Call this in your constructor.
+     *
+     * In frame mode, report any latency your processing adds on top of the frame via setProcessingLatencySamples instead
+     * of calling setLatencySamples directly. Frame mode can't be combined with a FixedLatency declaration.
+     */
+    void setRequiredFrameSize (int numSamples)
+    {
+        jassert (numSamples >= 0);
+        jassert (numSamples == 0 || ! hasFixedLatency);
+        jassert (numSamples == 0 || oversamplingFactor == 1);
+
+        requiredFrameSize = numSamples;
+        setLatencySamples (getSchedulingLatencySamples() + processingLatencySamples);
+    }
+
+    /**
+     * Sets the latency your processing adds on top of the frame fifo or oversampling filter latency, in samples at the
+     * host sample rate. The sum of both is reported to the host. Without a required frame size or oversampling, this is
+     * equivalent to calling setLatencySamples.
+     */
+    void setProcessingLatencySamples (int numSamples)
+    {
+        jassert (numSamples >= 0);
+
+        processingLatencySamples = numSamples;
+        setLatencySamples (getSchedulingLatencySamples() + processingLatencySamples);
+    }
+
+    /**
+     * Enables oversampling by a factor of 2, 4 or 8. Your processBlock is then called with the upsampled block and
+     * prepareResources, createProcessSpec, getSampleRate and getMaxNumSamplesPerBlock report the oversampled rate and
+     * block size. The filters are set up to have an integer latency, which is reported to the host and compensated in
+     * the bypass delay line. Pass a factor of 1 to disable oversampling, which is the default. Call this in your
+     * constructor.
+     *
+     * As with a required frame size, report additional latency via setProcessingLatencySamples instead of calling
+     * setLatencySamples directly. Oversampling can't be combined with a required frame size or a FixedLatency declaration.
+     */
+    void setOversampling (int factor, OversamplingFilter filter = OversamplingFilter::polyphaseIIR)
+    {
+        jassert (factor == 1 || factor == 2 || factor == 4 || factor == 8);
+        jassert (factor == 1 || (requiredFrameSize == 0 && ! hasFixedLatency));
+
+        oversamplingFactor = factor;
+        oversamplingFilter = filter;
+    }
+
+    /**
+     * Enables channel parallel processing for processors with heavy independent per channel work. The channels of each
+     * block are then distributed across the workers of the process wide SharedExecutor and the audio thread, and
+     * processChannel is called for each of them instead of processBlock. The realtime workers needed for the channel
+     * count are started in prepareToPlay. Call this in your constructor. By default, all channels are processed on the
+     * audio thread via processBlock.
+     */
+    void setChannelParallelProcessing (bool shouldProcessChannelsInParallel)
+    {
+        if (shouldProcessChannelsInParallel)
+            getSharedExecutor();
+
+        channelParallelProcessing = shouldProcessChannelsInParallel;
+    }
+
+    /**
+     * Called on a background thread after the processor has been bypassed for the time set via
+     * setReleaseResourcesAfterBypass. Free large allocations like impulse responses or lookup tables here. Note that
+     * prepareResources might be called while the resources are released.
+     */
+    virtual void releaseHeavyResources() {}
+
+    /**
+     * Called on a background thread when the processor leaves the bypass state after releaseHeavyResources was called.
+     * Allocate everything freed in releaseHeavyResources again. The processor stays bypassed until this has returned,
+     * then the crossfade to the processed signal starts.
+     */
+    virtual void reacquireHeavyResources() {}
+
+    /**
+     * Enables the release of heavy resources after the processor has been bypassed for the given number of seconds.
+     * Pass 0 to keep them allocated all the time, which is the default. This starts a timer, so call it from the message
+     * thread, usually in your constructor. The hooks run on the background workers of the shared executor and are
+     * stopped when the base class is destroyed, see stopHeavyResourceHooks.
+     */
+    void setReleaseResourcesAfterBypass (double seconds)
+    {
+        jassert (seconds >= 0.0);
+        releaseResourcesAfterBypassSeconds = seconds;
+
+        if (seconds > 0.0)
+            heavyResourceTimer.startTimer (100);
+        else
+            heavyResourceTimer.stopTimer();
+    }
+
+    /**
+     * Stops the release and reacquisition of heavy resources, cancels a hook that has not been started yet and waits
+     * for a running one. As the hooks run on the SharedExecutor, this cancels all other pending tasks of this instance
+     * as well. This happens automatically when the base class is destroyed, which is after your subclass. If your
+     * hooks access members of your subclass, call this from the message thread at the beginning of its destructor.
+     */
+    void stopHeavyResourceHooks()
+    {
+        heavyResourceTimer.stopTimer();
+
+        if (sharedExecutor != nullptr)
+            sharedExecutor->cancelPendingTasks();
+    }
+
+    /**
+     * Returns this instance's client of the SharedExecutor which is shared by all plugin instances in this process. Use it
+     * to run background tasks or to parallelise work on the audio thread without spawning threads per instance. The first
+     * call creates the client, so don't make it from the audio thread. Tasks still pending when the processor is
+     * destroyed are cancelled, but this happens after your subclass is destroyed. If your tasks refer to members of your
+     * subclass, call cancelPendingTasks in its destructor.
+     */
+    SharedExecutor::Client& getSharedExecutor()
+    {
+        if (sharedExecutor == nullptr)
+            sharedExecutor = std::make_unique<SharedExecutor::Client>();
+
+        return *sharedExecutor;
+    }
+
+    /**
+     * Enables silence suspension. If all input channels stay below the threshold for longer than the latency plus the
+     * tail length returned by getTailLengthSeconds, the processBlock call is skipped and the output is cleared until
+     * the first block with a non silent input sample arrives. Only enable this if your processor outputs silence for
+     * silent input after its tail, e.g. not for processors that generate sound on their own or from midi input. The tail
+     * length is queried in prepareToPlay.
+     */
+    void setSilenceSuspension (bool shouldSuspendOnSilence, float thresholdDecibels = -120.0f)
+    {
+        silenceSuspensionEnabled = shouldSuspendOnSilence;
+        silenceThreshold = juce::Decibels::decibelsToGain (thresholdDecibels);
+    }
+
+    /** Returns the number of blocks skipped by the silence suspension since the processor was created */
+    int64_t getNumSkippedSilentBlocks() const noexcept
+    {
+        return numSkippedBlocks.load (std::memory_order_relaxed);
+    }
 
-    int getMaxNumSamplesPerBlock() { return currentMaxNumSamplesPerBlock; }
+    /**
+     * Returns the meter that measures the time each processBlock call of this instance takes compared to the duration
+     * of the block. Read its statistics from a single non-realtime thread, e.g. in a timer callback of the editor.
+     */
+    ProcessLoadMeter& getLoadMeter() noexcept
+    {
+        return loadMeter;
+    }
+
+    /**
+     * Sets the gain curve used when fading between the processed and the bypassed signal. The default linear fade suits
+     * most effects, as the processed signal is usually correlated to the bypassed one. Takes effect on the next
+     * prepareToPlay call.
+     */
+    void setBypassFadeShape (CrossfadeShape newShape)
+    {
+        bypassFadeShape = newShape;
+    }
+
+    /** Returns the sample rate your processBlock runs at, which is the oversampled rate if oversampling is enabled */
+    double getSampleRate()         { return currentSampleRate * oversamplingFactor; }
+
+    /** Returns the maximum block size your processBlock sees, which is scaled by the oversampling factor */
+    int getMaxNumSamplesPerBlock() { return currentMaxNumSamplesPerBlock * oversamplingFactor; }
 
     /**
      * Creates a dsp::ProcessSpec object containig the current processors sampleRate, the current processors max number
@@ -126,102 +553,491 @@ public:
     juce::dsp::ProcessSpec createProcessSpec (int numChannels)
     {
         juce::dsp::ProcessSpec spec;
-        spec.sampleRate       = currentSampleRate;
-        spec.maximumBlockSize = static_cast<uint32_t> (currentMaxNumSamplesPerBlock);
+        spec.sampleRate       = getSampleRate();
+        spec.maximumBlockSize = static_cast<uint32_t> (getMaxNumSamplesPerBlock());
         spec.numChannels      = static_cast<uint32_t> (numChannels);
         return spec;
     }
 
+    /**
+     * Returns the values of all parameters as they were at the start of the current processBlock call, so that reading
+     * them is a plain load from a small struct. Only available if your ParameterProvider declares its parameters as a
+     * jb::ParameterList named Parameters. If the host block is split into sub blocks, all of them see the same values.
+     */
+    template <class Provider = ParameterProvider>
+    const typename Provider::Parameters::Snapshot& getParameterSnapshot() const noexcept
+    {
+        return parameterSnapshot.snapshot;
+    }
+
+    /** Returns the value of a single parameter from the snapshot of the current block, see getParameterSnapshot */
+    template <class Param>
+    auto getParameterValue() const noexcept
+    {
+        return getParameterSnapshot().template get<Param>();
+    }
+
+    /**
+     * Returns true if the parameter changed since your last processBlock call, so that coefficients or tables that
+     * depend on it only need to be recomputed if this returns true. All parameters count as changed in the first call.
+     * Changes made while your processBlock was not called, e.g. while bypassed or suspended on silence, are kept until
+     * the next call. If the block is processed in sub blocks or frames, only the first one sees the changes. Only
+     * available together with getParameterSnapshot.
+     */
+    template <class Param>
+    bool hasParameterChanged() const noexcept
+    {
+        return getParameterSnapshot().template hasChanged<Param>();
+    }
+
     juce::AudioProcessorValueTreeState parameters;
     juce::UndoManager                  undoManager;
     StateAndPresetManager              stateAndPresetManager;
 private:
+    /** The bypass delay line, buffers and frame fifo needed to process in one of the two sample precisions */
+    template <typename SampleType>
+    struct PrecisionResources
+    {
+        std::unique_ptr<MultichannelDelayLine<SampleType>> delayLine;
+        typename detail::FixedBypassDelayLine<ParameterProvider, SampleType>::Type fixedDelayLine;
+        juce::AudioBuffer<SampleType> tempBuffer;
+        CrossfadeTable<SampleType> crossfadeTable;
+        detail::FrameFifo<SampleType> frameFifo;
+        std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+    };
+
+    enum class BypassState
+    {
+        processing,
+        fadingToBypass,
+        bypassed,
+        fadingToProcessing
+    };
 
     void prepareToPlay (double newSampleRate, int maxNumSamplesPerBlock) override
     {
+        JB_TRACE_SCOPE ("PluginAudioProcessorBase::prepareToPlay");
+
+        // With a fixed internal block size, your processBlock never sees more samples than that. With a required
+        // frame size it sees exactly that number of samples
+        if (requiredFrameSize > 0)
+            maxNumSamplesPerBlock = requiredFrameSize;
+        else if (internalBlockSize > 0)
+            maxNumSamplesPerBlock = std::min (maxNumSamplesPerBlock, internalBlockSize);
+
         auto sampleRateChanged = ! juce::exactlyEqual (newSampleRate, currentSampleRate);
         auto samplesPerBlockChanged = maxNumSamplesPerBlock != currentMaxNumSamplesPerBlock;
 
         currentSampleRate = newSampleRate;
         currentMaxNumSamplesPerBlock = maxNumSamplesPerBlock;
 
+        // The oversampling is prepared first, so that the latency is known when preparing the bypass delay line
+        prepareOversampling();
         prepareResources (sampleRateChanged, samplesPerBlockChanged, false);
 
         prepareBypassDelayLine();
+
+        // The audio thread processes one of the channels itself
+        if (channelParallelProcessing)
+            sharedExecutor->requestRealtimeWorkers (std::max (getTotalNumInputChannels(), getTotalNumOutputChannels()) - 1);
     }
 
     void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiBuffer) override
     {
-        // If process block with bypass enabled is called, call processBlockBypassed
-        if (bypassParameter->getValue() > 0.5f)
+        processBlockInternal (buffer, midiBuffer);
+    }
+
+    void processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiBuffer) override
+    {
+        processBlockInternal (buffer, midiBuffer);
+    }
+
+    void processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiBuffer) override
+    {
+        processBlockBypassedInternal (buffer, midiBuffer);
+    }
+
+    void processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiBuffer) override
+    {
+        processBlockBypassedInternal (buffer, midiBuffer);
+    }
+
+    template <typename SampleType>
+    void processBlockInternal (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer&)
+    {
+        JB_TRACE_SCOPE ("PluginAudioProcessorBase::processBlock");
+        parameterSnapshot.update();
+        const ProcessLoadMeter::ScopedMeasurement loadMeasurement (loadMeter, buffer.getNumSamples(), currentSampleRate);
+
+        // Reports allocations, locks and file I/O anywhere below this point if JB_ENABLE_REALTIME_CHECKS is enabled
+        const ScopedRealtimeCheck realtimeCheck;
+
+        processInSubBlocks (buffer, false);
+    }
+
+    bool isBypassParameterOn() const noexcept
+    {
+        return bypassParameterValue->load (std::memory_order_relaxed) > 0.5f;
+    }
+
+    template <typename SampleType>
+    void processBlockBypassedInternal (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer&)
+    {
+        JB_TRACE_SCOPE ("PluginAudioProcessorBase::processBlockBypassed");
+        parameterSnapshot.update();
+        const ProcessLoadMeter::ScopedMeasurement loadMeasurement (loadMeter, buffer.getNumSamples(), currentSampleRate);
+
+        // Reports allocations, locks and file I/O anywhere below this point if JB_ENABLE_REALTIME_CHECKS is enabled
+        const ScopedRealtimeCheck realtimeCheck;
+
+        processInSubBlocks (buffer, true);
+    }
+
+    /**
+     * Splits the host buffer into sub blocks that are no longer than the maximum block size announced in prepareToPlay,
+     * so hosts that send more samples than announced don't require resizing anything on the audio thread. The bypass
+     * parameter is read once for the whole host buffer.
+     */
+    template <typename SampleType>
+    void processInSubBlocks (juce::AudioBuffer<SampleType>& buffer, bool hostBypassed)
+    {
+        juce::dsp::AudioBlock<SampleType> block (buffer);
+
+        const auto numSamples = buffer.getNumSamples();
+        const auto subBlockSize = getSubBlockSize();
+        const auto shouldBeBypassed = hostBypassed || isBypassParameterOn();
+
+        if (numSamples <= subBlockSize)
         {
-            processBlockBypassed (buffer, midiBuffer);
+            processWithBypassState (block, shouldBeBypassed);
             return;
         }
 
-        // If the last block was bypassed, a fade should occur
-        if (lastBlockWasBypassed)
+        // Sub blocks are views into the host buffer, creating them never allocates, regardless of the channel count
+        for (int start = 0; start < numSamples; start += subBlockSize)
+        {
+            auto subBlock = block.getSubBlock (static_cast<size_t> (start), static_cast<size_t> (std::min (subBlockSize, numSamples - start)));
+            processWithBypassState (subBlock, shouldBeBypassed);
+        }
+    }
+
+    int getSubBlockSize() const noexcept
+    {
+        // Not prepared yet, we can't do anything sensible but passing the block through
+        if (currentMaxNumSamplesPerBlock <= 0)
+            return std::numeric_limits<int>::max();
+
+        return currentMaxNumSamplesPerBlock;
+    }
+
+    /**
+     * Advances the bypass state machine by one block. Fades between the processed and the bypassed signal can span any
+     * number of blocks, so that the fade length does not depend on the host buffer size. If the bypass state is toggled
+     * again while a fade is running, the fade reverses from its current position.
+     */
+    template <typename SampleType>
+    void processWithBypassState (juce::dsp::AudioBlock<SampleType>& inOutBlock, bool shouldBeBypassed)
+    {
+        updateBypassDelayTime<SampleType>();
+
+        switch (bypassState)
+        {
+            case BypassState::processing:
+                if (shouldBeBypassed)
+                    startBypassFade (BypassState::fadingToBypass, 0);
+                break;
+
+            case BypassState::bypassed:
+                // If heavy resources were released, the processor stays bypassed until they are available again
+                if (! shouldBeBypassed && heavyResourcesAreAvailable())
+                {
+                    // The frame fifo and oversampling filters were not fed while bypassed, so their content is outdated
+                    auto& resources = getPrecisionResources<SampleType>();
+
+                    if (requiredFrameSize > 0)
+                        resources.frameFifo.reset();
+
+                    if (resources.oversampling != nullptr)
+                        resources.oversampling->reset();
+
+                    startBypassFade (BypassState::fadingToProcessing, 0);
+                }
+                break;
+
+            case BypassState::fadingToBypass:
+                if (! shouldBeBypassed)
+                    startBypassFade (BypassState::fadingToProcessing, bypassRampLen - bypassFadePosition);
+                break;
+
+            case BypassState::fadingToProcessing:
+                if (shouldBeBypassed)
+                    startBypassFade (BypassState::fadingToBypass, bypassRampLen - bypassFadePosition);
+                break;
+        }
+
+        switch (bypassState)
+        {
+            case BypassState::processing:
+                // The bypass delay line is fed while processing, so that a fade into bypass starts with the latency
+                // compensated input instead of the silence of an empty delay line
+                if (hasBypassDelayLine<SampleType>())
+                    pushIntoBypassDelayLine (inOutBlock);
+
+                if (canSkipSilentBlock (inOutBlock))
+                {
+                    inOutBlock.clear();
+                    numSkippedBlocks.fetch_add (1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    processUserBlock (inOutBlock);
+                }
+                break;
+
+            case BypassState::bypassed:
+                if (hasBypassDelayLine<SampleType>())
+                {
+                    auto bypassBlock = getBypassTempBlock (inOutBlock);
+
+                    processBypassDelayLine (inOutBlock, bypassBlock);
+                    inOutBlock.copyFrom (bypassBlock);
+                }
+
+                if (shouldBeBypassed)
+                    trackBypassDuration (static_cast<int> (inOutBlock.getNumSamples()));
+                break;
+
+            case BypassState::fadingToBypass:
+                processWithBypassFade<true> (inOutBlock);
+                break;
+
+            case BypassState::fadingToProcessing:
+                processWithBypassFade<false> (inOutBlock);
+                break;
+        }
+    }
+
+    /**
+     * Calls the users processBlock either directly, through the frame fifo if a required frame size is set or at the
+     * oversampled rate if oversampling is enabled
+     */
+    template <typename SampleType>
+    void processUserBlock (juce::dsp::AudioBlock<SampleType>& block)
+    {
+        auto& resources = getPrecisionResources<SampleType>();
+
+        if (requiredFrameSize > 0)
+        {
+            resources.frameFifo.process (block, [this] (juce::dsp::AudioBlock<SampleType>& frame) { processSerialOrParallel (frame); });
+        }
+        else if (resources.oversampling != nullptr)
         {
-            processWithBypassFade<false> (buffer);
-            lastBlockWasBypassed = false;
+            auto oversampledBlock = resources.oversampling->processSamplesUp (block);
+            processSerialOrParallel (oversampledBlock);
+            resources.oversampling->processSamplesDown (block);
         }
         else
         {
-            juce::dsp::AudioBlock<float> inOutBlock (buffer);
-            processBlock (inOutBlock);
+            processSerialOrParallel (block);
         }
     }
 
-    void processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+    /** Calls processBlock or distributes the channels over the worker pool if channel parallel processing is enabled */
+    template <typename SampleType>
+    void processSerialOrParallel (juce::dsp::AudioBlock<SampleType>& block)
     {
-        // If the last block was not bypassed, a fade should occur
-        if (!lastBlockWasBypassed)
+        if (channelParallelProcessing)
         {
-            processWithBypassFade<true> (buffer);
-            lastBlockWasBypassed = true;
+            sharedExecutor->parallelFor (static_cast<int> (block.getNumChannels()), [&] (int channelIdx)
+            {
+                const ScopedRealtimeCheck realtimeCheck;
+
+                auto channelBlock = block.getSingleChannelBlock (static_cast<size_t> (channelIdx));
+                processChannel (channelBlock, channelIdx);
+            });
         }
-        else if (delayLine != nullptr)
+        else
         {
-            bypassTempBuffer.setSize (buffer.getNumChannels(), buffer.getNumSamples(), false, false, true);
+            processBlock (block);
+        }
 
-            juce::dsp::AudioBlock<float> inOutBlock (buffer);
-            juce::dsp::AudioBlock<float> bypassBlock (bypassTempBuffer);
+        // Your code has seen the parameter changes now, so the next call only reports the ones that happen after this
+        parameterSnapshot.clearChanges();
+    }
+
+    /** Returns a view of the part of the bypass temp buffer that matches the block passed in */
+    template <typename SampleType>
+    juce::dsp::AudioBlock<SampleType> getBypassTempBlock (const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        auto& tempBuffer = getPrecisionResources<SampleType>().tempBuffer;
 
-            delayLine->processBlock (inOutBlock, bypassBlock);
-            inOutBlock.copyFrom (bypassBlock);
+        // The temp buffer is sized in prepareToPlay and processInSubBlocks never passes in longer blocks
+        jassert (block.getNumChannels() <= static_cast<size_t> (tempBuffer.getNumChannels()));
+        jassert (block.getNumSamples()  <= static_cast<size_t> (tempBuffer.getNumSamples()));
+
+        return juce::dsp::AudioBlock<SampleType> (tempBuffer).getSubsetChannelBlock (0, block.getNumChannels())
+                                                             .getSubBlock (0, block.getNumSamples());
+    }
+
+    /**
+     * Returns true if silence suspension is enabled and the input has been silent long enough for the latency and the
+     * tail of the processor to have passed, so that processing this block would only produce silence as well. The first
+     * block that contains a non silent sample is processed again.
+     */
+    template <typename SampleType>
+    bool canSkipSilentBlock (const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        if (! silenceSuspensionEnabled)
+            return false;
+
+        const auto numSamples  = static_cast<int> (block.getNumSamples());
+        const auto numChannels = std::min (static_cast<size_t> (getTotalNumInputChannels()), block.getNumChannels());
+
+        // A processor without inputs is a generator, its output does not depend on input silence
+        if (numChannels == 0)
+            return false;
+
+        for (size_t c = 0; c < numChannels; ++c)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax (block.getChannelPointer (c), numSamples);
+
+            if (std::max (-range.getStart(), range.getEnd()) > static_cast<SampleType> (silenceThreshold))
+            {
+                numSilentInputSamples = 0;
+                return false;
+            }
         }
+
+        const auto samplesUntilSilentOutput = silenceTailSamples + latencySamples.load();
+        const auto canSkip = numSilentInputSamples >= samplesUntilSilentOutput;
+
+        // Saturates instead of overflowing for an infinite tail
+        numSilentInputSamples = std::min (numSilentInputSamples + numSamples, std::numeric_limits<int64_t>::max() / 2);
+
+        return canSkip;
     }
 
-    template <bool fadeIntoBypass>
-    void processWithBypassFade (juce::AudioBuffer<float>& buffer)
+    /** Requests the release of heavy resources once the processor has been bypassed for the configured time */
+    void trackBypassDuration (int numSamples)
     {
-        bypassTempBuffer.setSize (buffer.getNumChannels(), buffer.getNumSamples(), false, false, true);
+        if (releaseResourcesAfterBypassSamples <= 0)
+            return;
 
-        juce::dsp::AudioBlock<float> inOutBlock (buffer);
-        juce::dsp::AudioBlock<float> bypassBlock (bypassTempBuffer);
+        // Only time spent bypassed with acquired resources counts, so that resources are not released again right
+        // after they were reacquired
+        if (heavyResourceState.load() != HeavyResourceState::acquired)
+        {
+            numBypassedSamples = 0;
+            return;
+        }
 
-        if (delayLine == nullptr)
+        numBypassedSamples += numSamples;
+
+        if (numBypassedSamples >= releaseResourcesAfterBypassSamples)
         {
-            bypassBlock.copyFrom (inOutBlock);
+            auto expected = HeavyResourceState::acquired;
+            heavyResourceState.compare_exchange_strong (expected, HeavyResourceState::releaseRequested);
         }
-        else
+    }
+
+    /**
+     * Called from the audio thread when leaving bypass. Cancels a release that was not started yet or requests the
+     * reacquisition of released resources. Returns true if the resources are available.
+     */
+    bool heavyResourcesAreAvailable()
+    {
+        auto state = heavyResourceState.load();
+
+        if (state == HeavyResourceState::releaseRequested
+            && heavyResourceState.compare_exchange_strong (state, HeavyResourceState::acquired))
+            return true;
+
+        if (state == HeavyResourceState::released
+            && heavyResourceState.compare_exchange_strong (state, HeavyResourceState::reacquireRequested))
+            numBypassedSamples = 0;
+
+        return state == HeavyResourceState::acquired;
+    }
+
+    /**
+     * Polls for release and reacquire requests from the audio thread and runs the hooks on the normal priority
+     * background workers of the shared executor
+     */
+    void handleHeavyResourceRequests()
+    {
+        auto expected = HeavyResourceState::releaseRequested;
+
+        if (heavyResourceState.compare_exchange_strong (expected, HeavyResourceState::releasing))
         {
-            if (fadeIntoBypass) delayLine->reset();
+            getSharedExecutor().submit ([this]
+            {
+                releaseHeavyResources();
+                heavyResourceState = HeavyResourceState::released;
+            }, SharedExecutor::Priority::low);
 
-            delayLine->processBlock (inOutBlock, bypassBlock);
+            return;
         }
 
-        processBlock (inOutBlock);
+        expected = HeavyResourceState::reacquireRequested;
 
-        auto rampLength = std::min (buffer.getNumSamples(), bypassRampLen);
+        if (heavyResourceState.compare_exchange_strong (expected, HeavyResourceState::reacquiring))
+        {
+            getSharedExecutor().submit ([this]
+            {
+                reacquireHeavyResources();
+                heavyResourceState = HeavyResourceState::acquired;
+            }, SharedExecutor::Priority::high);
+        }
+    }
 
-        constexpr float a = fadeIntoBypass ? 1.0f : 0.0f;
-        constexpr float b = fadeIntoBypass ? 0.0f : 1.0f;
+    void startBypassFade (BypassState fadeState, int fadePosition)
+    {
+        numSilentInputSamples = 0;
+        numBypassedSamples = 0;
 
-        buffer          .applyGainRamp (0, rampLength, a, b);
-        bypassTempBuffer.applyGainRamp (0, rampLength, b, a);
+        bypassState = fadeState;
+        bypassFadePosition = juce::jlimit (0, bypassRampLen, fadePosition);
+    }
 
-        inOutBlock.add (bypassBlock);
+    template <bool fadeIntoBypass, typename SampleType>
+    void processWithBypassFade (juce::dsp::AudioBlock<SampleType>& inOutBlock)
+    {
+        JB_TRACE_SCOPE ("PluginAudioProcessorBase::processWithBypassFade");
+
+        auto bypassBlock = getBypassTempBlock (inOutBlock);
+
+        if (hasBypassDelayLine<SampleType>())
+            processBypassDelayLine (inOutBlock, bypassBlock);
+        else
+            bypassBlock.copyFrom (inOutBlock);
+
+        processUserBlock (inOutBlock);
+
+        const auto& crossfadeTable = getPrecisionResources<SampleType>().crossfadeTable;
+        const auto numSamples = static_cast<int> (inOutBlock.getNumSamples());
+        const auto rampEnd = std::min (bypassFadePosition + numSamples, crossfadeTable.getLength());
+        const auto numRampSamples = std::max (0, rampEnd - bypassFadePosition);
+
+        for (size_t c = 0; c < inOutBlock.getNumChannels(); ++c)
+        {
+            auto* processed = inOutBlock.getChannelPointer (c);
+            const auto* bypassed = bypassBlock.getChannelPointer (c);
+
+            if constexpr (fadeIntoBypass)
+            {
+                crossfadeTable.crossfade (processed, bypassed, processed, bypassFadePosition, rampEnd);
+                std::copy (bypassed + numRampSamples, bypassed + numSamples, processed + numRampSamples);
+            }
+            else
+            {
+                crossfadeTable.crossfade (processed, processed, bypassed, bypassFadePosition, rampEnd);
+            }
+        }
+
+        bypassFadePosition += numRampSamples;
+
+        if (bypassFadePosition >= crossfadeTable.getLength())
+            bypassState = fadeIntoBypass ? BypassState::bypassed : BypassState::processing;
     }
 
     void numChannelsChanged() override
@@ -229,22 +1045,205 @@ private:
         if (currentSampleRate == 0.0)
             currentSampleRate = 50e3;
 
+        prepareOversampling();
         prepareResources (false, false, true);
         prepareBypassDelayLine();
     }
 
+    /** Creates the oversampling stage for the precision the host chose and updates its latency */
+    void prepareOversampling()
+    {
+        if (isUsingDoublePrecision())
+            prepareOversampling (doubleResources);
+        else
+            prepareOversampling (floatResources);
+    }
+
+    template <typename SampleType>
+    void prepareOversampling (PrecisionResources<SampleType>& resources)
+    {
+        if (oversamplingFactor == 1)
+        {
+            resources.oversampling.reset();
+            oversamplingLatencySamples = 0;
+            return;
+        }
+
+        const auto filterType = oversamplingFilter == OversamplingFilter::polyphaseIIR ? juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR
+                                                                                       : juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple;
+
+        const auto numChannels = static_cast<size_t> (std::max (getTotalNumInputChannels(), getTotalNumOutputChannels()));
+        const auto factorLog2  = static_cast<size_t> (std::log2 (oversamplingFactor));
+
+        resources.oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>> (numChannels, factorLog2, filterType, true, true);
+        resources.oversampling->initProcessing (static_cast<size_t> (currentMaxNumSamplesPerBlock));
+
+        oversamplingLatencySamples = juce::roundToInt (resources.oversampling->getLatencyInSamples());
+    }
+
+    /** The latency added by the frame fifo or the oversampling filters */
+    int getSchedulingLatencySamples() const noexcept
+    {
+        return requiredFrameSize + oversamplingLatencySamples;
+    }
+
+    /** Prepares the bypass resources for the precision the host chose and frees the ones of the other precision */
     void prepareBypassDelayLine()
     {
-        if (auto delayLineDepth = getLatencySamples())
+        if (requiredFrameSize > 0 || oversamplingFactor > 1)
+            setLatencySamples (getSchedulingLatencySamples() + processingLatencySamples);
+
+        bypassRampLen = std::max (1, juce::roundToInt (bypassFadeLengthMs * 0.001 * currentSampleRate));
+        releaseResourcesAfterBypassSamples = static_cast<int64_t> (releaseResourcesAfterBypassSeconds * currentSampleRate);
+
+        const auto tailSeconds = getTailLengthSeconds();
+        numSilentInputSamples = 0;
+        silenceTailSamples = std::isfinite (tailSeconds) ? static_cast<int64_t> (std::ceil (tailSeconds * currentSampleRate))
+                                                         : std::numeric_limits<int64_t>::max() / 2;
+
+        // A fade that was running when the processor got prepared again is skipped
+        if (bypassState == BypassState::fadingToBypass)
+            bypassState = BypassState::bypassed;
+        else if (bypassState == BypassState::fadingToProcessing)
+            bypassState = BypassState::processing;
+
+        if (isUsingDoublePrecision())
+        {
+            prepareBypassDelayLine (doubleResources);
+            releasePrecisionResources (floatResources);
+        }
+        else
+        {
+            prepareBypassDelayLine (floatResources);
+            releasePrecisionResources (doubleResources);
+        }
+    }
+
+    template <typename SampleType>
+    void prepareBypassDelayLine (PrecisionResources<SampleType>& resources)
+    {
+        if (resources.crossfadeTable.getLength() != bypassRampLen || resources.crossfadeTable.getShape() != bypassFadeShape)
+            resources.crossfadeTable.setRamp (bypassRampLen, bypassFadeShape);
+
+        auto& delayLine = resources.delayLine;
+
+        if constexpr (hasFixedLatency)
         {
-            auto numChans = getTotalNumOutputChannels();
-            delayLine = std::make_unique<jb::MultichannelDelayLine<float>> (delayLineDepth, numChans);
-            bypassTempBuffer.setSize (numChans, currentMaxNumSamplesPerBlock);
+            // The fixed latency declared by the ParameterProvider has to match the latency reported to the host and the
+            // channel count must not exceed the declared maximum. The bypass block spans the inputs as well, e.g. a
+            // sidechain. Surplus channels are silenced by the delay line.
+            jassert (getLatencySamples() == ParameterProvider::FixedLatency::numSamples);
+            jassert (std::max (getTotalNumInputChannels(), getTotalNumOutputChannels()) <= ParameterProvider::FixedLatency::maxNumChannels);
+
+            resources.fixedDelayLine.reset();
+        }
+        else if (auto delayLineDepth = std::max (getLatencySamples(), maximumLatencySamples + getSchedulingLatencySamples()))
+        {
+            // Matches the channel count of the blocks passed to the bypass path
+            auto numChans = std::max (getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+            // An existing delay line is reused as long as it is long enough
+            if (delayLine == nullptr || delayLine->getLength() < delayLineDepth || delayLine->getNumChannels() != numChans)
+                delayLine = std::make_unique<jb::MultichannelDelayLine<SampleType>> (delayLineDepth, numChans);
+            else
+                delayLine->reset();
+
+            delayLine->setDelay (getLatencySamples());
         }
         else
         {
             delayLine.reset (nullptr);
         }
+
+        const auto numChannels = std::max (getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+        // The temp buffer holds the bypassed signal during fades as well, so it is needed even without latency
+        resources.tempBuffer.setSize (numChannels, currentMaxNumSamplesPerBlock);
+
+        if (requiredFrameSize > 0)
+            resources.frameFifo.prepare (numChannels, requiredFrameSize);
+    }
+
+    template <typename SampleType>
+    static void releasePrecisionResources (PrecisionResources<SampleType>& resources)
+    {
+        resources.delayLine.reset (nullptr);
+        resources.tempBuffer.setSize (0, 0);
+        resources.frameFifo.prepare (0, 0);
+        resources.oversampling.reset();
+        resources.crossfadeTable.setRamp (0, resources.crossfadeTable.getShape());
+    }
+
+    /** Follows latency changes made while processing by moving the read position of the bypass delay line */
+    template <typename SampleType>
+    void updateBypassDelayTime()
+    {
+        if constexpr (! hasFixedLatency)
+        {
+            // getLatencySamples isn't safe to call here while the latency is changed from another thread
+            const auto latency = latencySamples.load();
+            auto& delayLine = getPrecisionResources<SampleType>().delayLine;
+
+            if (delayLine == nullptr)
+            {
+                // If you hit this, you changed the latency while processing without declaring the maximum latency
+                // via setMaximumLatencySamples. The bypassed signal won't be delayed until the next prepareToPlay call
+                jassert (latency == 0);
+                return;
+            }
+
+            if (delayLine->getDelay() != latency)
+            {
+                // If you hit this, the latency exceeds the maximum declared via setMaximumLatencySamples
+                jassert (latency <= delayLine->getLength());
+
+                delayLine->setDelay (std::min (latency, delayLine->getLength()), latencyChangeFadeLength);
+            }
+        }
+    }
+
+    template <typename SampleType>
+    bool hasBypassDelayLine()
+    {
+        if constexpr (hasFixedLatency)
+            return true;
+        else
+            return getPrecisionResources<SampleType>().delayLine != nullptr;
+    }
+
+    template <typename SampleType>
+    void pushIntoBypassDelayLine (const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        auto push = [&block] (auto& delayLine)
+        {
+            const auto numChannels = std::min (block.getNumChannels(), static_cast<size_t> (delayLine.getNumChannels()));
+
+            for (size_t c = 0; c < numChannels; ++c)
+                delayLine.pushBuffer (block.getChannelPointer (c), static_cast<int> (block.getNumSamples()), static_cast<int> (c));
+        };
+
+        if constexpr (hasFixedLatency)
+            push (getPrecisionResources<SampleType>().fixedDelayLine);
+        else
+            push (*getPrecisionResources<SampleType>().delayLine);
+    }
+
+    template <typename SampleType>
+    void processBypassDelayLine (const juce::dsp::AudioBlock<SampleType>& srcBlock, juce::dsp::AudioBlock<SampleType>& destBlock)
+    {
+        if constexpr (hasFixedLatency)
+            getPrecisionResources<SampleType>().fixedDelayLine.processBlock (srcBlock, destBlock);
+        else
+            getPrecisionResources<SampleType>().delayLine->processBlock (srcBlock, destBlock);
+    }
+
+    template <typename SampleType>
+    PrecisionResources<SampleType>& getPrecisionResources()
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return doubleResources;
+        else
+            return floatResources;
     }
 
     // I don't ever plan to build a plugin without editor
@@ -274,12 +1273,78 @@ private:
     int    currentMaxNumSamplesPerBlock = 0;
     double currentSampleRate = 0.0;
 
+    // Block scheduling
+    int internalBlockSize = 0;
+    int requiredFrameSize = 0;
+    int processingLatencySamples = 0;
+    int oversamplingFactor = 1;
+    int oversamplingLatencySamples = 0;
+    OversamplingFilter oversamplingFilter = OversamplingFilter::polyphaseIIR;
+    bool channelParallelProcessing = false;
+
+    // Silence suspension
+    bool                 silenceSuspensionEnabled = false;
+    float                silenceThreshold = 0.0f;
+    int64_t              silenceTailSamples = 0;
+    int64_t              numSilentInputSamples = 0;
+    std::atomic<int64_t> numSkippedBlocks { 0 };
+
+    ProcessLoadMeter loadMeter;
+
+    // Heavy resource release while bypassed
+    enum class HeavyResourceState
+    {
+        acquired,
+        releaseRequested,
+        releasing,
+        released,
+        reacquireRequested,
+        reacquiring
+    };
+
+    /**
+     * Calls handleHeavyResourceRequests on the message thread. It's a member rather than a base class, so that your
+     * subclass can be a juce::Timer itself. Destroying it stops the hooks before the shared executor client goes away.
+     */
+    class HeavyResourceTimer : public juce::Timer
+    {
+    public:
+        explicit HeavyResourceTimer (PluginAudioProcessorBase& p) : owner (p) {}
+
+        ~HeavyResourceTimer() override { owner.stopHeavyResourceHooks(); }
+
+        void timerCallback() override { owner.handleHeavyResourceRequests(); }
+
+    private:
+        PluginAudioProcessorBase& owner;
+    };
+
+    std::atomic<HeavyResourceState> heavyResourceState { HeavyResourceState::acquired };
+    double                          releaseResourcesAfterBypassSeconds = 0.0;
+    int64_t                         releaseResourcesAfterBypassSamples = 0;
+    int64_t                         numBypassedSamples = 0;
+    std::unique_ptr<SharedExecutor::Client> sharedExecutor;
+    HeavyResourceTimer                      heavyResourceTimer { *this };
+
+    // Parameter values of the current block
+    typename detail::ParameterSnapshotType<ParameterProvider>::Type parameterSnapshot;
+
     // Bypass handling
-    juce::AudioProcessorParameter*                bypassParameter;
-    std::unique_ptr<MultichannelDelayLine<float>> delayLine;
-    juce::AudioBuffer<float>                      bypassTempBuffer;
-    bool                                          lastBlockWasBypassed;
-    int                                           bypassRampLen = 128;
+    static constexpr bool hasFixedLatency = detail::HasFixedLatency<ParameterProvider>::value;
+
+    juce::AudioProcessorParameter* bypassParameter;
+    std::atomic<float>*            bypassParameterValue;
+    PrecisionResources<float>      floatResources;
+    PrecisionResources<double>     doubleResources;
+    BypassState                    bypassState = BypassState::processing;
+    int                            bypassFadePosition = 0;
+    double                         bypassFadeLengthMs = 3.0;
+    int                            bypassRampLen = 128;
+    CrossfadeShape                 bypassFadeShape = CrossfadeShape::linear;
+    int                            maximumLatencySamples = 0;
+    std::atomic<int>               latencySamples { 0 };
+
+    static constexpr int latencyChangeFadeLength = 128;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginAudioProcessorBase)
 };
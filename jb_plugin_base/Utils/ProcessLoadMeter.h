@@ -0,0 +1,203 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/**
+ * Measures how much of the realtime budget each processed block used. The budget of a block is its duration, i.e.
+ * numSamples / sampleRate, so a load of 1.0 means that processing took exactly as long as playing back the block and
+ * the host would have missed its deadline if it had nothing else to do.
+ *
+ * The audio thread pushes one load value per block into a lock-free single producer single consumer ring. A single
+ * reader thread, e.g. the editor in a timer callback or a logging thread, drains the ring into a histogram with 1%
+ * resolution from which it computes percentiles. If the reader falls behind by more than ringSize blocks, the newest
+ * measurements are dropped and counted.
+ *
+ * PluginAudioProcessorBase owns one of these per instance and measures each call of processBlock.
+ */
+class ProcessLoadMeter
+{
+public:
+    struct Statistics
+    {
+        int64_t numBlocks              = 0;
+        int64_t numXrunRiskBlocks      = 0;
+        int64_t numDroppedMeasurements = 0;
+
+        /** Loads as fraction of the realtime budget, percentiles are rounded up to the next 1% */
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    /** Measures the time between construction and destruction and adds it to the meter */
+    class ScopedMeasurement
+    {
+    public:
+        ScopedMeasurement (ProcessLoadMeter& meterToUse, int numSamples, double sampleRate) noexcept
+          : meter (meterToUse),
+            budgetSeconds (sampleRate > 0.0 ? numSamples / sampleRate : 0.0),
+            startTicks (juce::Time::getHighResolutionTicks())
+        {}
+
+        ~ScopedMeasurement()
+        {
+            if (budgetSeconds > 0.0)
+                meter.addMeasurement (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks), budgetSeconds);
+        }
+
+    private:
+        ProcessLoadMeter& meter;
+        const double      budgetSeconds;
+        const int64_t     startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedMeasurement)
+    };
+
+    /** Blocks with a load above the threshold are counted as xrun risk, see setXrunRiskThreshold */
+    static constexpr double defaultXrunRiskThreshold = 0.8;
+
+    /** Number of measurements the ring can hold before the reader has to drain it */
+    static constexpr uint32_t ringSize = 1024;
+
+    //==============================================================================
+    // Audio thread
+
+    /** Adds the load of a block that took elapsedSeconds to process. Lock and allocation free. */
+    void addMeasurement (double elapsedSeconds, double budgetSeconds) noexcept
+    {
+        const auto write = writeIndex.load (std::memory_order_relaxed);
+
+        if (write - readIndex.load (std::memory_order_acquire) >= ringSize)
+        {
+            numDropped.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+
+        ring[write & (ringSize - 1)] = static_cast<float> (elapsedSeconds / budgetSeconds);
+        writeIndex.store (write + 1, std::memory_order_release);
+    }
+
+    //==============================================================================
+    // Reader thread, only one thread at a time may call these functions
+
+    /** Blocks above this load are counted as xrun risk, defaults to 0.8. Only affects blocks collected afterwards. */
+    void setXrunRiskThreshold (double newThreshold) noexcept
+    {
+        jassert (newThreshold > 0.0);
+        xrunRiskThreshold = newThreshold;
+    }
+
+    /** Drains pending measurements and returns the statistics of all blocks since construction or the last reset */
+    Statistics getStatistics() noexcept
+    {
+        drainRing();
+
+        Statistics stats;
+        stats.numBlocks              = numBlocks;
+        stats.numXrunRiskBlocks      = numXrunRiskBlocks;
+        stats.numDroppedMeasurements = numDropped.load (std::memory_order_relaxed);
+        stats.p50                    = getPercentile (0.5);
+        stats.p99                    = getPercentile (0.99);
+        stats.max                    = maxLoad;
+
+        return stats;
+    }
+
+    /** Discards all measurements so far, e.g. to let a meter show the statistics of the last second only */
+    void resetStatistics() noexcept
+    {
+        drainRing();
+
+        histogram.fill (0);
+        numBlocks         = 0;
+        numXrunRiskBlocks = 0;
+        maxLoad           = 0.0;
+        numDropped.store (0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int    numHistogramBins  = 200;
+    static constexpr double histogramBinWidth = 0.01;
+
+    // Audio thread to reader
+    std::array<float, ringSize> ring {};
+    std::atomic<uint32_t>       writeIndex { 0 };
+    std::atomic<uint32_t>       readIndex  { 0 };
+    std::atomic<int64_t>        numDropped { 0 };
+
+    // Reader only, the last bin collects all loads above the histogram range
+    std::array<int64_t, numHistogramBins + 1> histogram {};
+    int64_t numBlocks         = 0;
+    int64_t numXrunRiskBlocks = 0;
+    double  maxLoad           = 0.0;
+    double  xrunRiskThreshold = defaultXrunRiskThreshold;
+
+    void drainRing() noexcept
+    {
+        const auto write = writeIndex.load (std::memory_order_acquire);
+        auto read = readIndex.load (std::memory_order_relaxed);
+
+        for (; read != write; ++read)
+        {
+            const double load = ring[read & (ringSize - 1)];
+
+            const auto bin = std::min (static_cast<int> (load / histogramBinWidth), numHistogramBins);
+            ++histogram[static_cast<size_t> (bin)];
+
+            ++numBlocks;
+            maxLoad = std::max (maxLoad, load);
+
+            if (load > xrunRiskThreshold)
+                ++numXrunRiskBlocks;
+        }
+
+        readIndex.store (read, std::memory_order_release);
+    }
+
+    double getPercentile (double percentile) const noexcept
+    {
+        if (numBlocks == 0)
+            return 0.0;
+
+        const auto rank = std::max (int64_t (1), static_cast<int64_t> (std::ceil (percentile * static_cast<double> (numBlocks))));
+
+        int64_t count = 0;
+
+        for (int bin = 0; bin < numHistogramBins; ++bin)
+        {
+            count += histogram[static_cast<size_t> (bin)];
+
+            if (count >= rank)
+                return std::min ((bin + 1) * histogramBinWidth, maxLoad);
+        }
+
+        return maxLoad;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessLoadMeter)
+};
+
+}
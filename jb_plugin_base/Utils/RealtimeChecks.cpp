@@ -0,0 +1,371 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#if JB_ENABLE_REALTIME_CHECKS
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #define JB_REALTIME_CHECKS_INTERPOSE_LIBC 1
+ #include <cstdarg>
+ #include <cstddef>
+ #include <dlfcn.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <unistd.h>
+
+ #include <cstring>
+#else
+ #define JB_REALTIME_CHECKS_INTERPOSE_LIBC 0
+#endif
+
+// Initial exec TLS never allocates on access, which matters as these are read from inside the allocation functions
+#if JUCE_GCC || JUCE_CLANG
+ #define JB_REALTIME_CHECKS_TLS __attribute__ ((tls_model ("initial-exec")))
+#else
+ #define JB_REALTIME_CHECKS_TLS
+#endif
+
+namespace jb
+{
+    static thread_local int realtimeCheckDepth JB_REALTIME_CHECKS_TLS = 0;
+    static thread_local int realtimeCheckSuspensionDepth JB_REALTIME_CHECKS_TLS = 0;
+
+    static void defaultRealtimeViolationHandler (const char* description)
+    {
+        juce::Logger::outputDebugString (juce::String ("Realtime violation on the audio thread: ") + description + "\n"
+                                         + juce::SystemStats::getStackBacktrace());
+        jassertfalse;
+    }
+
+    static std::atomic<void (*) (const char*)> realtimeViolationHandler { defaultRealtimeViolationHandler };
+
+    ScopedRealtimeCheck::ScopedRealtimeCheck() noexcept  { ++realtimeCheckDepth; }
+    ScopedRealtimeCheck::~ScopedRealtimeCheck() noexcept { --realtimeCheckDepth; }
+
+    bool ScopedRealtimeCheck::isActiveOnThisThread() noexcept
+    {
+        return realtimeCheckDepth > 0 && realtimeCheckSuspensionDepth == 0;
+    }
+
+    void ScopedRealtimeCheck::setViolationHandler (void (*handler) (const char*)) noexcept
+    {
+        realtimeViolationHandler = handler != nullptr ? handler : defaultRealtimeViolationHandler;
+    }
+
+    void ScopedRealtimeCheck::reportViolation (const char* description) noexcept
+    {
+        if (! isActiveOnThisThread())
+            return;
+
+        // The handler may allocate or lock itself, which must not be reported again
+        const ScopedRealtimeCheckSuspension suspension;
+        realtimeViolationHandler.load() (description);
+    }
+
+    ScopedRealtimeCheckSuspension::ScopedRealtimeCheckSuspension() noexcept  { ++realtimeCheckSuspensionDepth; }
+    ScopedRealtimeCheckSuspension::~ScopedRealtimeCheckSuspension() noexcept { --realtimeCheckSuspensionDepth; }
+
+    namespace detail
+    {
+       #if JB_REALTIME_CHECKS_INTERPOSE_LIBC
+        /**
+         * Resolves the definition of a libc function that the rest of the process uses. Our own interposers are
+         * hidden and therefore invisible to dlsym, so RTLD_DEFAULT yields e.g. the malloc of an allocator that the
+         * host preloaded, which RTLD_NEXT would skip when this binary was opened with dlopen.
+         */
+        template <typename FunctionType>
+        static FunctionType nextLibcFunction (FunctionType& cached, const char* name) noexcept
+        {
+            if (cached == nullptr)
+                cached = reinterpret_cast<FunctionType> (dlsym (RTLD_DEFAULT, name));
+
+            return cached;
+        }
+
+        static void* (*nextMalloc)  (size_t)         = nullptr;
+        static void* (*nextCalloc)  (size_t, size_t) = nullptr;
+        static void* (*nextRealloc) (void*, size_t)  = nullptr;
+        static void  (*nextFree)    (void*)          = nullptr;
+
+        // dlsym calls calloc itself, allocations made while the allocator is being resolved are served from here
+        alignas (std::max_align_t) static char bootstrapArena[4096];
+        static std::atomic<size_t> bootstrapArenaUsed { 0 };
+        static thread_local bool isResolvingAllocator JB_REALTIME_CHECKS_TLS = false;
+
+        static bool isBootstrapAllocation (const void* ptr) noexcept
+        {
+            return ptr >= bootstrapArena && ptr < bootstrapArena + sizeof (bootstrapArena);
+        }
+
+        static void* bootstrapAllocate (size_t size) noexcept
+        {
+            constexpr auto alignment = alignof (std::max_align_t);
+            const auto alignedSize = (size + alignment - 1) / alignment * alignment;
+            const auto offset = bootstrapArenaUsed.fetch_add (alignedSize);
+
+            if (alignedSize > sizeof (bootstrapArena) || offset > sizeof (bootstrapArena) - alignedSize)
+                return nullptr;
+
+            return bootstrapArena + offset;
+        }
+
+        /** Returns false while the allocator is being resolved on the calling thread */
+        static bool resolveAllocator() noexcept
+        {
+            if (nextFree != nullptr)
+                return true;
+
+            if (isResolvingAllocator)
+                return false;
+
+            isResolvingAllocator = true;
+            nextLibcFunction (nextMalloc,  "malloc");
+            nextLibcFunction (nextCalloc,  "calloc");
+            nextLibcFunction (nextRealloc, "realloc");
+            nextLibcFunction (nextFree,    "free");
+            isResolvingAllocator = false;
+
+            return nextFree != nullptr;
+        }
+
+        static void* rawMalloc (size_t size) noexcept
+        {
+            return resolveAllocator() ? nextMalloc (size) : bootstrapAllocate (size);
+        }
+
+        static void* rawCalloc (size_t num, size_t size) noexcept
+        {
+            if (resolveAllocator())
+                return nextCalloc (num, size);
+
+            // The arena is zero initialised and never reused, so there is nothing to clear
+            if (size != 0 && num > std::numeric_limits<size_t>::max() / size)
+                return nullptr;
+
+            return bootstrapAllocate (num * size);
+        }
+
+        static void* rawRealloc (void* ptr, size_t size) noexcept
+        {
+            if (! isBootstrapAllocation (ptr))
+                return resolveAllocator() ? nextRealloc (ptr, size) : bootstrapAllocate (size);
+
+            // The size of a bootstrap allocation is not stored, copying up to the end of the arena is always safe
+            const auto bytesToArenaEnd = static_cast<size_t> (bootstrapArena + sizeof (bootstrapArena) - static_cast<char*> (ptr));
+            auto* newPtr = rawMalloc (size);
+
+            if (newPtr != nullptr)
+                std::memcpy (newPtr, ptr, std::min (size, bytesToArenaEnd));
+
+            return newPtr;
+        }
+
+        static void rawFree (void* ptr) noexcept
+        {
+            if (ptr == nullptr || isBootstrapAllocation (ptr))
+                return;
+
+            if (resolveAllocator())
+                nextFree (ptr);
+        }
+       #else
+        static void* rawMalloc (size_t size) noexcept { return std::malloc (size); }
+        static void  rawFree   (void* ptr)   noexcept { std::free (ptr); }
+       #endif
+
+        static void* checkedNew (size_t size, const char* description)
+        {
+            ScopedRealtimeCheck::reportViolation (description);
+
+            if (auto* ptr = rawMalloc (size == 0 ? 1 : size))
+                return ptr;
+
+            throw std::bad_alloc();
+        }
+
+        static void* checkedNewNoThrow (size_t size, const char* description) noexcept
+        {
+            ScopedRealtimeCheck::reportViolation (description);
+            return rawMalloc (size == 0 ? 1 : size);
+        }
+
+        static void checkedDelete (void* ptr, const char* description) noexcept
+        {
+            if (ptr == nullptr)
+                return;
+
+            ScopedRealtimeCheck::reportViolation (description);
+            rawFree (ptr);
+        }
+
+       #if JB_REALTIME_CHECKS_INTERPOSE_LIBC
+        static int     (*nextPthreadMutexLock) (pthread_mutex_t*)                 = nullptr;
+        static FILE*   (*nextFopen)            (const char*, const char*)         = nullptr;
+        static int     (*nextOpen)             (const char*, int, ...)            = nullptr;
+        static ssize_t (*nextRead)             (int, void*, size_t)               = nullptr;
+        static ssize_t (*nextWrite)            (int, const void*, size_t)         = nullptr;
+
+        // dlsym may allocate and lock, so everything is resolved at load time rather than on first use. Allocations
+        // from static initialisers that run earlier resolve the allocator on demand
+        [[maybe_unused]] static const bool libcFunctionsResolved = [] {
+            return resolveAllocator()
+                && nextLibcFunction (nextPthreadMutexLock, "pthread_mutex_lock") != nullptr
+                && nextLibcFunction (nextFopen,            "fopen")              != nullptr
+                && nextLibcFunction (nextOpen,             "open")               != nullptr
+                && nextLibcFunction (nextRead,             "read")               != nullptr
+                && nextLibcFunction (nextWrite,            "write")              != nullptr;
+        }();
+       #endif
+    }
+}
+
+//==============================================================================
+// Replacing the global operators catches allocations from all code that ends up in this binary. The aligned overloads
+// are left to the standard library, they are rare enough that we don't bother
+#if defined (__ELF__)
+// Like the libc interposers below, the operators must not be exported. Otherwise the definitions of an already loaded
+// libstdc++ take precedence for calls made from this binary and nothing is reported. The mangled names encode size_t
+ #if __SIZEOF_SIZE_T__ == 8
+__asm__ (".hidden _Znwm");
+__asm__ (".hidden _Znam");
+__asm__ (".hidden _ZnwmRKSt9nothrow_t");
+__asm__ (".hidden _ZnamRKSt9nothrow_t");
+__asm__ (".hidden _ZdlPvm");
+__asm__ (".hidden _ZdaPvm");
+ #else
+__asm__ (".hidden _Znwj");
+__asm__ (".hidden _Znaj");
+__asm__ (".hidden _ZnwjRKSt9nothrow_t");
+__asm__ (".hidden _ZnajRKSt9nothrow_t");
+__asm__ (".hidden _ZdlPvj");
+__asm__ (".hidden _ZdaPvj");
+ #endif
+__asm__ (".hidden _ZdlPv");
+__asm__ (".hidden _ZdaPv");
+__asm__ (".hidden _ZdlPvRKSt9nothrow_t");
+__asm__ (".hidden _ZdaPvRKSt9nothrow_t");
+#endif
+
+void* operator new   (size_t size)                        { return jb::detail::checkedNew (size, "operator new"); }
+void* operator new[] (size_t size)                        { return jb::detail::checkedNew (size, "operator new[]"); }
+void* operator new   (size_t size, const std::nothrow_t&) noexcept { return jb::detail::checkedNewNoThrow (size, "operator new"); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept { return jb::detail::checkedNewNoThrow (size, "operator new[]"); }
+
+void operator delete   (void* ptr) noexcept                        { jb::detail::checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr) noexcept                        { jb::detail::checkedDelete (ptr, "operator delete[]"); }
+void operator delete   (void* ptr, size_t) noexcept                { jb::detail::checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr, size_t) noexcept                { jb::detail::checkedDelete (ptr, "operator delete[]"); }
+void operator delete   (void* ptr, const std::nothrow_t&) noexcept { jb::detail::checkedDelete (ptr, "operator delete"); }
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept { jb::detail::checkedDelete (ptr, "operator delete[]"); }
+
+#if JB_REALTIME_CHECKS_INTERPOSE_LIBC
+//==============================================================================
+// Hidden visibility makes these shadow the libc functions for all calls made from this binary, including JUCE and
+// statically linked libraries, while the host and other plugins in the same process are not affected. The libc
+// headers already declared them with default visibility, so the symbols are hidden on the assembler level instead
+__asm__ (".hidden malloc");
+__asm__ (".hidden calloc");
+__asm__ (".hidden realloc");
+__asm__ (".hidden free");
+__asm__ (".hidden pthread_mutex_lock");
+__asm__ (".hidden fopen");
+__asm__ (".hidden open");
+__asm__ (".hidden read");
+__asm__ (".hidden write");
+
+#define JB_REALTIME_CHECKS_INTERPOSER extern "C"
+
+JB_REALTIME_CHECKS_INTERPOSER void* malloc (size_t size) noexcept
+{
+    jb::ScopedRealtimeCheck::reportViolation ("malloc");
+    return jb::detail::rawMalloc (size);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER void* calloc (size_t num, size_t size) noexcept
+{
+    jb::ScopedRealtimeCheck::reportViolation ("calloc");
+    return jb::detail::rawCalloc (num, size);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER void* realloc (void* ptr, size_t size) noexcept
+{
+    jb::ScopedRealtimeCheck::reportViolation ("realloc");
+    return jb::detail::rawRealloc (ptr, size);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER void free (void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        jb::ScopedRealtimeCheck::reportViolation ("free");
+
+    jb::detail::rawFree (ptr);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+{
+    jb::ScopedRealtimeCheck::reportViolation ("pthread_mutex_lock");
+    return jb::detail::nextLibcFunction (jb::detail::nextPthreadMutexLock, "pthread_mutex_lock") (mutex);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER FILE* fopen (const char* path, const char* mode)
+{
+    jb::ScopedRealtimeCheck::reportViolation ("fopen");
+    return jb::detail::nextLibcFunction (jb::detail::nextFopen, "fopen") (path, mode);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER int open (const char* path, int flags, ...)
+{
+    jb::ScopedRealtimeCheck::reportViolation ("open");
+
+    mode_t mode = 0;
+
+    if ((flags & O_CREAT) != 0 || (flags & O_TMPFILE) == O_TMPFILE)
+    {
+        va_list args;
+        va_start (args, flags);
+        mode = static_cast<mode_t> (va_arg (args, int));
+        va_end (args);
+    }
+
+    return jb::detail::nextLibcFunction (jb::detail::nextOpen, "open") (path, flags, mode);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER ssize_t read (int fd, void* buffer, size_t numBytes)
+{
+    jb::ScopedRealtimeCheck::reportViolation ("read");
+    return jb::detail::nextLibcFunction (jb::detail::nextRead, "read") (fd, buffer, numBytes);
+}
+
+JB_REALTIME_CHECKS_INTERPOSER ssize_t write (int fd, const void* buffer, size_t numBytes)
+{
+    jb::ScopedRealtimeCheck::reportViolation ("write");
+    return jb::detail::nextLibcFunction (jb::detail::nextWrite, "write") (fd, buffer, numBytes);
+}
+
+#undef JB_REALTIME_CHECKS_INTERPOSER
+#endif // JB_REALTIME_CHECKS_INTERPOSE_LIBC
+
+#undef JB_REALTIME_CHECKS_TLS
+#undef JB_REALTIME_CHECKS_INTERPOSE_LIBC
+
+#endif // JB_ENABLE_REALTIME_CHECKS
@@ -0,0 +1,88 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/**
+ * Marks a scope on the current thread in which no realtime violations are expected. With JB_ENABLE_REALTIME_CHECKS
+ * enabled, heap allocations, mutex locks and file I/O that happen while such a scope is active on a thread are
+ * reported through the violation handler. Without it, this compiles to nothing.
+ *
+ * PluginAudioProcessorBase creates one around the whole audio processing path, including the channel jobs that run
+ * on the SharedExecutor workers, so user code in processBlock and processChannel is covered automatically. Scopes
+ * can be nested.
+ */
+class ScopedRealtimeCheck
+{
+public:
+#if JB_ENABLE_REALTIME_CHECKS
+    ScopedRealtimeCheck() noexcept;
+    ~ScopedRealtimeCheck() noexcept;
+
+    /** Returns true if a ScopedRealtimeCheck is alive on the calling thread and checks are not suspended */
+    static bool isActiveOnThisThread() noexcept;
+
+    /**
+     * Replaces the function that is called with a short description for each violation. The default handler logs
+     * the description along with a stack trace and hits a jassertfalse. Pass nullptr to restore it. The handler is
+     * called with checks suspended, so it may allocate itself.
+     */
+    static void setViolationHandler (void (*handler) (const char* description)) noexcept;
+
+    /** Reports a violation if a check is active on the calling thread, can be used to flag custom blocking calls */
+    static void reportViolation (const char* description) noexcept;
+#else
+    ScopedRealtimeCheck() noexcept {}
+    ~ScopedRealtimeCheck() noexcept {}
+
+    static bool isActiveOnThisThread() noexcept { return false; }
+    static void setViolationHandler (void (*) (const char*)) noexcept {}
+    static void reportViolation (const char*) noexcept {}
+#endif
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeCheck)
+};
+
+/**
+ * Suspends the checks of an enclosing ScopedRealtimeCheck on the current thread, for calls that are known to be
+ * non-realtime but accepted, e.g. a one-off allocation while preparing a new configuration.
+ */
+class ScopedRealtimeCheckSuspension
+{
+public:
+#if JB_ENABLE_REALTIME_CHECKS
+    ScopedRealtimeCheckSuspension() noexcept;
+    ~ScopedRealtimeCheckSuspension() noexcept;
+#else
+    ScopedRealtimeCheckSuspension() noexcept {}
+    ~ScopedRealtimeCheckSuspension() noexcept {}
+#endif
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeCheckSuspension)
+};
+
+}
@@ -0,0 +1,486 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#if JUCE_LINUX || JUCE_ANDROID
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+ #if JUCE_MSVC
+  #pragma comment (lib, "Synchronization.lib")
+ #endif
+#endif
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace jb
+{
+    static_assert (sizeof (std::atomic<uint32_t>) == sizeof (uint32_t), "The futex word must be a plain 32 bit integer");
+
+    namespace detail
+    {
+        /** Blocks while word equals value, using a futex on Linux, WaitOnAddress on Windows and a yield and sleep loop elsewhere */
+        static void waitWhileEqual (std::atomic<uint32_t>& word, uint32_t value)
+        {
+           #if JUCE_LINUX || JUCE_ANDROID
+            while (word.load (std::memory_order_acquire) == value)
+                syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+           #elif JUCE_WINDOWS
+            while (word.load (std::memory_order_acquire) == value)
+                WaitOnAddress (&word, &value, sizeof (value), INFINITE);
+           #else
+            for (int i = 0; word.load (std::memory_order_acquire) == value; ++i)
+            {
+                if (i < 100)
+                    std::this_thread::yield();
+                else
+                    std::this_thread::sleep_for (std::chrono::microseconds (50));
+            }
+           #endif
+        }
+
+        /** Tells the cpu that we are busy waiting, so that it saves power and leaves resources to a hyperthread sibling */
+        static void pauseSpinning() noexcept
+        {
+           #if JUCE_INTEL
+            _mm_pause();
+           #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+            __asm__ __volatile__ ("yield");
+           #endif
+        }
+
+        /** Wakes all threads blocked in waitWhileEqual on that word */
+        static void wakeAllWaiting (std::atomic<uint32_t>& word)
+        {
+           #if JUCE_LINUX || JUCE_ANDROID
+            syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+           #elif JUCE_WINDOWS
+            WakeByAddressAll (&word);
+           #else
+            juce::ignoreUnused (word);
+           #endif
+        }
+    }
+
+    /** Index of the queue owned by the current thread, -1 if it's no background worker of the shared executor */
+    static thread_local int currentWorkerIdx = -1;
+
+    class SharedExecutor::Worker : public juce::Thread
+    {
+    public:
+        /** A negative index creates a realtime worker, which has no task queue */
+        Worker (SharedExecutor& e, const juce::String& name, int idx)
+          : juce::Thread (name),
+            executor (e),
+            workerIdx (idx)
+        {}
+
+        void run() override
+        {
+            if (workerIdx < 0)
+            {
+                executor.realtimeWorkerLoop();
+                return;
+            }
+
+            currentWorkerIdx = workerIdx;
+            executor.backgroundWorkerLoop (workerIdx);
+        }
+
+    private:
+        SharedExecutor& executor;
+        const int workerIdx;
+    };
+
+    //==============================================================================
+    SharedExecutor::Client::Client()
+      : executor (SharedExecutor::addClient (*this))
+    {}
+
+    SharedExecutor::Client::~Client()
+    {
+        cancelPendingTasks();
+        SharedExecutor::removeClient (*this);
+    }
+
+    void SharedExecutor::Client::submit (std::function<void()> task, Priority priority)
+    {
+        ++tasksSubmitted;
+        executor.submit ({ std::move (task), this }, priority);
+    }
+
+    void SharedExecutor::Client::cancelPendingTasks()
+    {
+        executor.cancelPendingTasks (*this);
+    }
+
+    void SharedExecutor::Client::requestRealtimeWorkers (int numWorkers)
+    {
+        executor.startRealtimeWorkers (numWorkers);
+    }
+
+    SharedExecutor::Statistics SharedExecutor::Client::getStatistics() const
+    {
+        return { tasksSubmitted.load(),
+                 tasksCompleted.load(),
+                 tasksCancelled.load(),
+                 realtimeJobsExecuted.load(),
+                 juce::Time::highResolutionTicksToSeconds (busyTicks.load()) };
+    }
+
+    int SharedExecutor::Client::getNumWorkerThreads() const noexcept
+    {
+        return executor.numRealtimeWorkers.load (std::memory_order_acquire);
+    }
+
+    //==============================================================================
+    SharedExecutor& SharedExecutor::addClient (Client& client)
+    {
+        const juce::ScopedLock sl (sharedResourcesLock);
+
+        if (instance == nullptr)
+        {
+            const auto maxNumRealtimeWorkers = std::max (1, juce::SystemStats::getNumCpus() - 1);
+            instance.reset (new SharedExecutor (maxNumRealtimeWorkers, std::max (1, maxNumRealtimeWorkers / 2)));
+        }
+
+        allClients.add (&client);
+        return *instance;
+    }
+
+    void SharedExecutor::removeClient (Client& client)
+    {
+        std::unique_ptr<SharedExecutor> executorToDelete;
+
+        {
+            const juce::ScopedLock sl (sharedResourcesLock);
+            allClients.removeAllInstancesOf (&client);
+
+            if (allClients.isEmpty())
+                executorToDelete = std::move (instance);
+        }
+
+        // The workers are joined outside the lock, a new client may already create a new executor meanwhile
+        executorToDelete.reset();
+    }
+
+    int SharedExecutor::getNumClients()
+    {
+        const juce::ScopedLock sl (sharedResourcesLock);
+        return allClients.size();
+    }
+
+    //==============================================================================
+    SharedExecutor::SharedExecutor (int maxRealtimeWorkers, int numBackgroundWorkers)
+      : maxNumRealtimeWorkers (maxRealtimeWorkers)
+    {
+        for (int i = 0; i < numBackgroundWorkers; ++i)
+            queues.push_back (std::make_unique<WorkerQueue>());
+
+        for (int i = 0; i < numBackgroundWorkers; ++i)
+        {
+            backgroundWorkers.push_back (std::make_unique<Worker> (*this, "jb SharedExecutor background " + juce::String (i), i));
+            backgroundWorkers.back()->startThread (juce::Thread::Priority::normal);
+        }
+    }
+
+    SharedExecutor::~SharedExecutor()
+    {
+        shouldExit = true;
+        signalWork (realtimeWorkSignal);
+        signalWork (backgroundWorkSignal);
+
+        for (auto& w : realtimeWorkers)
+            w->stopThread (1000);
+
+        for (auto& w : backgroundWorkers)
+            w->stopThread (1000);
+    }
+
+    void SharedExecutor::startRealtimeWorkers (int numWorkers)
+    {
+        const juce::ScopedLock sl (realtimeWorkersLock);
+
+        const auto numWorkersNeeded = std::min (numWorkers, maxNumRealtimeWorkers);
+
+        while (static_cast<int> (realtimeWorkers.size()) < numWorkersNeeded)
+        {
+            realtimeWorkers.push_back (std::make_unique<Worker> (*this, "jb SharedExecutor realtime " + juce::String (realtimeWorkers.size()), -1));
+
+            // Falls back to a normal thread if the system denies realtime scheduling
+            if (! realtimeWorkers.back()->startRealtimeThread (juce::Thread::RealtimeOptions{}))
+                realtimeWorkers.back()->startThread (juce::Thread::Priority::highest);
+        }
+
+        numRealtimeWorkers.store (static_cast<int> (realtimeWorkers.size()), std::memory_order_release);
+    }
+
+    void SharedExecutor::runRealtimeJobs (Client& client, int numJobs, JobFunction function, void* context)
+    {
+        // The job index is stored in 16 bit
+        jassert (numJobs < 0xffff);
+
+        if (numJobs <= 0)
+            return;
+
+        RealtimeSlot* slot = nullptr;
+
+        // Without any realtime workers there is nobody to share the jobs with
+        if (numJobs > 1 && numRealtimeWorkers.load (std::memory_order_acquire) > 0)
+        {
+            for (auto& s : realtimeSlots)
+            {
+                bool expected = false;
+
+                if (s.inUse.compare_exchange_strong (expected, true, std::memory_order_acquire))
+                {
+                    slot = &s;
+                    break;
+                }
+            }
+        }
+
+        // Nothing to share, no workers or all slots are taken, so we do the work ourselves
+        if (slot == nullptr)
+        {
+            for (int i = 0; i < numJobs; ++i)
+                function (context, i);
+
+            client.realtimeJobsExecuted += numJobs;
+            return;
+        }
+
+        slot->function = function;
+        slot->context  = context;
+        slot->client   = &client;
+        slot->generation++;
+        slot->jobsRemaining.store (static_cast<uint32_t> (numJobs), std::memory_order_relaxed);
+        slot->jobCounter.store ((uint64_t (slot->generation) << 32) | (uint64_t (numJobs) << 16), std::memory_order_release);
+
+        signalWork (realtimeWorkSignal);
+
+        executeRealtimeJobs (*slot, false);
+
+        // Wait for the jobs taken by the workers
+        for (int i = 0; slot->jobsRemaining.load (std::memory_order_acquire) != 0; ++i)
+        {
+            if (i < numSpinIterations)
+            {
+                detail::pauseSpinning();
+                continue;
+            }
+
+            const auto remaining = slot->jobsRemaining.load (std::memory_order_acquire);
+
+            if (remaining != 0)
+                detail::waitWhileEqual (slot->jobsRemaining, remaining);
+        }
+
+        slot->inUse.store (false, std::memory_order_release);
+    }
+
+    bool SharedExecutor::executeRealtimeJobs()
+    {
+        auto executedAny = false;
+
+        for (auto& slot : realtimeSlots)
+            if (slot.inUse.load (std::memory_order_acquire))
+                executedAny |= executeRealtimeJobs (slot, true);
+
+        return executedAny;
+    }
+
+    bool SharedExecutor::executeRealtimeJobs (RealtimeSlot& slot, bool measureTime)
+    {
+        auto executedAny = false;
+        auto counter = slot.jobCounter.load (std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto numJobs = static_cast<int> ((counter >> 16) & 0xffff);
+            const auto nextJob = static_cast<int> (counter & 0xffff);
+
+            if (nextJob >= numJobs)
+                return executedAny;
+
+            if (! slot.jobCounter.compare_exchange_weak (counter, counter + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+
+            // The slot can't be reused before this job is finished, so the job data belongs to the job we just took
+            auto* client = slot.client;
+            const auto start = measureTime ? juce::Time::getHighResolutionTicks() : 0;
+
+            slot.function (slot.context, nextJob);
+
+            if (measureTime)
+                client->busyTicks += juce::Time::getHighResolutionTicks() - start;
+
+            ++client->realtimeJobsExecuted;
+            executedAny = true;
+
+            if (slot.jobsRemaining.fetch_sub (1, std::memory_order_acq_rel) == 1)
+                detail::wakeAllWaiting (slot.jobsRemaining);
+
+            counter = slot.jobCounter.load (std::memory_order_acquire);
+        }
+    }
+
+    void SharedExecutor::submit (Task&& task, Priority priority)
+    {
+        // Tasks submitted by a task running on a background worker go to that worker's queue, others are distributed
+        // round robin
+        const auto queueIdx = currentWorkerIdx >= 0 ? static_cast<size_t> (currentWorkerIdx)
+                                                    : static_cast<size_t> (nextQueue++ % queues.size());
+
+        auto& queue = *queues[queueIdx];
+
+        {
+            const juce::SpinLock::ScopedLockType sl (queue.lock);
+            queue.tasks[static_cast<size_t> (priority)].push_back (std::move (task));
+        }
+
+        signalWork (backgroundWorkSignal);
+    }
+
+    void SharedExecutor::cancelPendingTasks (Client& client)
+    {
+        for (auto& queue : queues)
+        {
+            const juce::SpinLock::ScopedLockType sl (queue->lock);
+
+            for (auto& tasks : queue->tasks)
+            {
+                const auto numTasksBefore = tasks.size();
+                tasks.erase (std::remove_if (tasks.begin(), tasks.end(), [&] (const Task& t) { return t.client == &client; }), tasks.end());
+                client.tasksCancelled += static_cast<int64_t> (numTasksBefore - tasks.size());
+            }
+        }
+
+        // A task that was already taken by a worker can't be cancelled, so we have to wait for it. The executor's
+        // signal is used instead of the client's counter, as the client may be destroyed right after this returns
+        for (;;)
+        {
+            const auto signal = taskFinishedSignal.load (std::memory_order_acquire);
+
+            if (client.numRunningTasks.load() == 0)
+                return;
+
+            detail::waitWhileEqual (taskFinishedSignal, signal);
+        }
+    }
+
+    bool SharedExecutor::executeBackgroundTask (int workerIdx)
+    {
+        const auto numQueues = queues.size();
+
+        for (size_t p = 0; p < 3; ++p)
+        {
+            // Our own queue is worked off from the back, other queues are stolen from at the front
+            for (size_t i = 0; i < numQueues; ++i)
+            {
+                const auto isOwnQueue = i == 0;
+                auto& queue = *queues[(static_cast<size_t> (workerIdx) + i) % numQueues];
+
+                Task task;
+
+                {
+                    const juce::SpinLock::ScopedLockType sl (queue.lock);
+                    auto& tasks = queue.tasks[p];
+
+                    if (tasks.empty())
+                        continue;
+
+                    if (isOwnQueue)
+                    {
+                        task = std::move (tasks.back());
+                        tasks.pop_back();
+                    }
+                    else
+                    {
+                        task = std::move (tasks.front());
+                        tasks.pop_front();
+                    }
+
+                    // Incremented under the lock, so that a client being destroyed can't miss this task
+                    ++task.client->numRunningTasks;
+                }
+
+                const auto start = juce::Time::getHighResolutionTicks();
+                task.function();
+                task.client->busyTicks += juce::Time::getHighResolutionTicks() - start;
+                ++task.client->tasksCompleted;
+                --task.client->numRunningTasks;
+
+                signalWork (taskFinishedSignal);
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void SharedExecutor::signalWork (std::atomic<uint32_t>& workSignal)
+    {
+        workSignal.fetch_add (1, std::memory_order_release);
+        detail::wakeAllWaiting (workSignal);
+    }
+
+    void SharedExecutor::realtimeWorkerLoop()
+    {
+        while (! shouldExit)
+        {
+            const auto signal = realtimeWorkSignal.load (std::memory_order_acquire);
+
+            if (executeRealtimeJobs())
+                continue;
+
+            // Spin briefly first, as the next job round usually follows within microseconds while the host is processing
+            for (int i = 0; i < numSpinIterations && realtimeWorkSignal.load (std::memory_order_acquire) == signal; ++i)
+                detail::pauseSpinning();
+
+            detail::waitWhileEqual (realtimeWorkSignal, signal);
+        }
+    }
+
+    void SharedExecutor::backgroundWorkerLoop (int workerIdx)
+    {
+        while (! shouldExit)
+        {
+            const auto signal = backgroundWorkSignal.load (std::memory_order_acquire);
+
+            if (executeBackgroundTask (workerIdx))
+                continue;
+
+            detail::waitWhileEqual (backgroundWorkSignal, signal);
+        }
+    }
+
+    std::unique_ptr<SharedExecutor> SharedExecutor::instance;
+    juce::Array<SharedExecutor::Client*> SharedExecutor::allClients;
+    juce::CriticalSection SharedExecutor::sharedResourcesLock;
+}
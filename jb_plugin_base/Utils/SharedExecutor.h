@@ -0,0 +1,201 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+/**
+ * A process wide pool of worker threads shared by all plugin instances loaded into the same process, so that a session
+ * with many instances does not oversubscribe the cpu with per instance helper threads.
+ *
+ * The executor is created when the first Client is constructed and destroyed together with the last one, similar to the
+ * static registry of the StateAndPresetManager. Each plugin instance owns a Client through which it submits work:
+ * - Realtime jobs via parallelFor. This is safe to call from the audio thread, it does not allocate or lock. The calling
+ *   thread executes jobs itself and returns when all jobs are finished, which is the deadline of these jobs. They run on
+ *   realtime priority workers, which are only started when a client requests them via requestRealtimeWorkers. The pool
+ *   grows to the largest number requested, but never beyond one worker per cpu core minus one, leaving a core for the
+ *   host audio threads.
+ * - Background tasks via submit, with a priority. They run on a separate, smaller set of normal priority workers, so
+ *   that disk I/O or allocations in a task never compete with the audio threads. Each background worker keeps its own
+ *   queue per priority and steals tasks from the other workers' queues when its own ones are empty.
+ *
+ * Clients count the work executed on their behalf and their pending tasks are cancelled when they are destroyed.
+ */
+class SharedExecutor
+{
+public:
+    enum class Priority
+    {
+        high,
+        normal,
+        low
+    };
+
+    struct Statistics
+    {
+        int64_t tasksSubmitted;
+        int64_t tasksCompleted;
+        int64_t tasksCancelled;
+        int64_t realtimeJobsExecuted;
+
+        /** Time the workers spent executing tasks and realtime jobs of this client */
+        double workerBusySeconds;
+    };
+
+    class Client
+    {
+    public:
+        /** Creates the shared executor if this is the first client in the process */
+        Client();
+
+        /** Cancels all pending tasks and waits for running tasks of this client to finish */
+        ~Client();
+
+        /**
+         * Calls job (index) for every index in [0, numJobs) and returns once all of them are finished. The calling
+         * thread takes jobs itself, so this also makes progress if all workers are busy. Safe to call from the audio
+         * thread. If too many clients call this at the same time, the jobs are executed on the calling thread.
+         */
+        template <typename Job>
+        void parallelFor (int numJobs, Job&& job)
+        {
+            executor.runRealtimeJobs (*this, numJobs, [] (void* context, int index) { (*static_cast<std::remove_reference_t<Job>*> (context)) (index); }, &job);
+        }
+
+        /** Queues a task for the background workers. This allocates, so don't call it from the audio thread */
+        void submit (std::function<void()> task, Priority priority = Priority::normal);
+
+        /** Removes all tasks of this client that have not been started yet and waits for the ones that are running */
+        void cancelPendingTasks();
+
+        /**
+         * Starts realtime workers until there are at least numWorkers of them or one per cpu core minus one. Call this
+         * before using parallelFor, e.g. in prepareToPlay, but not from the audio thread as it may start threads. Until
+         * workers are running, parallelFor executes all jobs on the calling thread.
+         */
+        void requestRealtimeWorkers (int numWorkers);
+
+        Statistics getStatistics() const;
+
+        /** Returns the number of realtime workers that share the jobs of parallelFor with the calling thread */
+        int getNumWorkerThreads() const noexcept;
+
+    private:
+        friend class SharedExecutor;
+
+        SharedExecutor& executor;
+
+        std::atomic<int64_t> tasksSubmitted       { 0 };
+        std::atomic<int64_t> tasksCompleted       { 0 };
+        std::atomic<int64_t> tasksCancelled       { 0 };
+        std::atomic<int64_t> realtimeJobsExecuted { 0 };
+        std::atomic<int64_t> busyTicks            { 0 };
+        std::atomic<int>     numRunningTasks      { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Client)
+    };
+
+    ~SharedExecutor();
+
+    /** Returns the number of clients, which is usually the number of plugin instances using the executor */
+    static int getNumClients();
+
+private:
+    class Worker;
+
+    using JobFunction = void (*) (void*, int);
+
+    struct Task
+    {
+        std::function<void()> function;
+        Client*               client = nullptr;
+    };
+
+    struct WorkerQueue
+    {
+        juce::SpinLock lock;
+        std::array<std::deque<Task>, 3> tasks;
+    };
+
+    /** A parallelFor call in progress. The slots are preallocated, so that publishing jobs does not allocate */
+    struct RealtimeSlot
+    {
+        std::atomic<bool> inUse { false };
+
+        // The upper 32 bit hold a generation count, the next 16 the number of jobs and the lower 16 the next job to take.
+        // As the generation changes each time the slot is reused, a late worker can't take a job of a later call
+        std::atomic<uint64_t> jobCounter    { 0 };
+        std::atomic<uint32_t> jobsRemaining { 0 };
+
+        JobFunction function   = nullptr;
+        void*       context    = nullptr;
+        Client*     client     = nullptr;
+        uint32_t    generation = 0;
+    };
+
+    SharedExecutor (int maxRealtimeWorkers, int numBackgroundWorkers);
+
+    void startRealtimeWorkers (int numWorkers);
+
+    void runRealtimeJobs (Client& client, int numJobs, JobFunction function, void* context);
+    void submit (Task&& task, Priority priority);
+    void cancelPendingTasks (Client& client);
+
+    void realtimeWorkerLoop();
+    void backgroundWorkerLoop (int workerIdx);
+    bool executeRealtimeJobs();
+    bool executeRealtimeJobs (RealtimeSlot& slot, bool measureTime);
+    bool executeBackgroundTask (int workerIdx);
+
+    static void signalWork (std::atomic<uint32_t>& workSignal);
+
+    static SharedExecutor& addClient (Client& client);
+    static void removeClient (Client& client);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::unique_ptr<Worker>>      realtimeWorkers;
+    std::vector<std::unique_ptr<Worker>>      backgroundWorkers;
+    std::array<RealtimeSlot, 32>              realtimeSlots;
+
+    const int             maxNumRealtimeWorkers;
+    std::atomic<int>      numRealtimeWorkers   { 0 };
+    juce::CriticalSection realtimeWorkersLock;
+
+    std::atomic<uint32_t> realtimeWorkSignal   { 0 };
+    std::atomic<uint32_t> backgroundWorkSignal { 0 };
+    std::atomic<uint32_t> taskFinishedSignal   { 0 };
+    std::atomic<uint32_t> nextQueue            { 0 };
+    std::atomic<bool>     shouldExit           { false };
+
+    static std::unique_ptr<SharedExecutor> instance;
+    static juce::Array<Client*>            allClients;
+    static juce::CriticalSection           sharedResourcesLock;
+
+    // Each iteration executes a pause instruction, so this keeps an idle worker awake for a few microseconds only
+    static constexpr int numSpinIterations = 200;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedExecutor)
+};
+
+}
@@ -0,0 +1,192 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+#if JB_ENABLE_TRACING
+
+namespace jb
+{
+    class Tracing::ThreadBuffer
+    {
+    public:
+        ThreadBuffer (int trackId, const juce::String& name)
+          : tid (trackId),
+            threadName (name),
+            events (new Event[eventsPerThread])
+        {}
+
+        void write (const char* name, int64_t startTicks, int64_t endTicks) noexcept
+        {
+            const auto index = numWritten.load (std::memory_order_relaxed);
+            auto& e = events[index & (eventsPerThread - 1)];
+
+            // An odd sequence marks the event as being written, so that a concurrent reader skips it
+            e.sequence.store (2 * index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+
+            e.name      .store (name,       std::memory_order_relaxed);
+            e.startTicks.store (startTicks, std::memory_order_relaxed);
+            e.endTicks  .store (endTicks,   std::memory_order_relaxed);
+
+            e.sequence.store (2 * index + 2, std::memory_order_release);
+            numWritten.store (index + 1, std::memory_order_release);
+        }
+
+        /** Calls callback (name, startTicks, endTicks) for each event that is not overwritten while reading it */
+        template <typename Callback>
+        void forEachEvent (Callback&& callback) const
+        {
+            const auto end   = numWritten.load (std::memory_order_acquire);
+            const auto begin = end > eventsPerThread ? end - eventsPerThread : 0;
+
+            for (auto index = begin; index < end; ++index)
+            {
+                const auto& e = events[index & (eventsPerThread - 1)];
+
+                const auto sequence = e.sequence.load (std::memory_order_acquire);
+                if (sequence != 2 * index + 2)
+                    continue;
+
+                const auto* name       = e.name      .load (std::memory_order_relaxed);
+                const auto  startTicks = e.startTicks.load (std::memory_order_relaxed);
+                const auto  endTicks   = e.endTicks  .load (std::memory_order_relaxed);
+
+                std::atomic_thread_fence (std::memory_order_acquire);
+                if (e.sequence.load (std::memory_order_relaxed) != sequence)
+                    continue;
+
+                callback (name, startTicks, endTicks);
+            }
+        }
+
+        const int          tid;
+        const juce::String threadName;
+
+    private:
+        struct Event
+        {
+            std::atomic<uint64_t>    sequence   { 0 };
+            std::atomic<const char*> name       { nullptr };
+            std::atomic<int64_t>     startTicks { 0 };
+            std::atomic<int64_t>     endTicks   { 0 };
+        };
+
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t>    numWritten { 0 };
+    };
+
+    struct Tracing::Registry
+    {
+        juce::CriticalSection                      lock;
+        std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+        std::atomic<int64_t> clearTicks { 0 };
+    };
+
+    Tracing::Registry& Tracing::getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    Tracing::ThreadBuffer& Tracing::getThreadBuffer()
+    {
+        static thread_local ThreadBuffer* threadBuffer = nullptr;
+
+        if (threadBuffer == nullptr)
+        {
+            // Happens once per thread, which is accepted even on the audio thread
+            const ScopedRealtimeCheckSuspension suspension;
+
+            auto& registry = getRegistry();
+            const juce::ScopedLock scopedLock (registry.lock);
+
+            const auto tid = static_cast<int> (registry.threadBuffers.size()) + 1;
+            juce::String name;
+
+            if (auto* thread = juce::Thread::getCurrentThread())
+                name = thread->getThreadName();
+            else if (juce::MessageManager::existsAndIsCurrentThread())
+                name = "Message thread";
+            else
+                name = "Thread " + juce::String (tid);
+
+            registry.threadBuffers.push_back (std::make_unique<ThreadBuffer> (tid, name));
+            threadBuffer = registry.threadBuffers.back().get();
+        }
+
+        return *threadBuffer;
+    }
+
+    void Tracing::record (const char* name, int64_t startTicks, int64_t endTicks) noexcept
+    {
+        getThreadBuffer().write (name, startTicks, endTicks);
+    }
+
+    void Tracing::clear() noexcept
+    {
+        // Events are not removed from the buffers, which would race with the recording threads, but hidden when writing
+        getRegistry().clearTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    bool Tracing::writeChromeTrace (const juce::File& file)
+    {
+        auto& registry = getRegistry();
+
+        const auto clearTicks = registry.clearTicks.load();
+        const auto toMicroseconds = [&] (int64_t ticks) { return juce::String (juce::Time::highResolutionTicksToSeconds (ticks) * 1e6, 3); };
+
+        juce::MemoryOutputStream json;
+        json << "{\"traceEvents\":[";
+
+        auto separator = "\n";
+
+        const juce::ScopedLock scopedLock (registry.lock);
+
+        for (auto& buffer : registry.threadBuffers)
+        {
+            const auto tid = juce::String (buffer->tid);
+
+            json << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                 << ",\"args\":{\"name\":" << juce::JSON::toString (buffer->threadName) << "}}";
+            separator = ",\n";
+
+            buffer->forEachEvent ([&] (const char* name, int64_t startTicks, int64_t endTicks)
+            {
+                if (startTicks < clearTicks)
+                    return;
+
+                json << separator << "{\"name\":" << juce::JSON::toString (juce::String (name))
+                     << ",\"cat\":\"jb\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                     << ",\"ts\":" << toMicroseconds (startTicks)
+                     << ",\"dur\":" << toMicroseconds (endTicks - startTicks) << "}";
+            });
+        }
+
+        json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        return file.replaceWithData (json.getData(), json.getDataSize());
+    }
+}
+
+#endif // JB_ENABLE_TRACING
@@ -0,0 +1,91 @@
+/*
+ MIT License
+
+ Copyright (c) 2020 Janos Buttgereit
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+ */
+
+namespace jb
+{
+
+#if JB_ENABLE_TRACING
+
+/**
+ * Records the durations of scopes marked with JB_TRACE_SCOPE on all threads of the process and writes them to a file in
+ * the Chrome trace event format, which can be opened in ui.perfetto.dev or chrome://tracing. Each thread shows up as a
+ * separate track, so a single timeline shows how audio processing, disk access and UI work interleave.
+ *
+ * Each thread records into its own lock-free ring buffer which keeps the most recent eventsPerThread events. Recording
+ * does not lock, the first event recorded on a thread allocates its buffer though. Writing the trace can happen on
+ * any thread while the others keep recording.
+ */
+class Tracing
+{
+public:
+    /** The number of most recent events kept per thread */
+    static constexpr uint32_t eventsPerThread = 1 << 15;
+
+    /** Writes all recorded events to the file, replacing its content. Returns false if the file could not be written. */
+    static bool writeChromeTrace (const juce::File& file);
+
+    /** Discards all events recorded so far */
+    static void clear() noexcept;
+
+    /** Records an event, the name must be a string literal or otherwise outlive the trace */
+    static void record (const char* name, int64_t startTicks, int64_t endTicks) noexcept;
+
+    /** Records the lifetime of the scope it is created in, use it through JB_TRACE_SCOPE */
+    class Scope
+    {
+    public:
+        explicit Scope (const char* nameToUse) noexcept
+          : name (nameToUse),
+            startTicks (juce::Time::getHighResolutionTicks())
+        {}
+
+        ~Scope()
+        {
+            record (name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char*   name;
+        const int64_t startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+private:
+    class ThreadBuffer;
+    struct Registry;
+
+    static Registry& getRegistry();
+    static ThreadBuffer& getThreadBuffer();
+};
+
+/** Records the enclosing scope under the given string literal name if JB_ENABLE_TRACING is enabled */
+#define JB_TRACE_SCOPE(name) const jb::Tracing::Scope JUCE_JOIN_MACRO (jbTraceScope_, __LINE__) (name)
+
+#else
+
+#define JB_TRACE_SCOPE(name)
+
+#endif // JB_ENABLE_TRACING
+}
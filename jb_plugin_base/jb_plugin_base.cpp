@@ -2,4 +2,7 @@
 #include "jb_plugin_base.h"
 
 #include "Presets/PresetManager.cpp"
-#include "Presets/SettingsManager.cpp"
\ No newline at end of file
+#include "Presets/SettingsManager.cpp"
+#include "Utils/RealtimeChecks.cpp"
+#include "Utils/SharedExecutor.cpp"
+#include "Utils/Tracing.cpp"
@@ -54,9 +54,31 @@
 #define JB_INCLUDE_JSON 0
 #endif
 
+/** Config: JB_ENABLE_REALTIME_CHECKS
+    Enables a detector for realtime violations on the audio thread, meant for debug and test builds.
+    While a jb::ScopedRealtimeCheck is alive on a thread, which PluginAudioProcessorBase creates around
+    the whole audio processing path, heap allocations through operator new and delete are reported
+    with a stack trace. On Linux with glibc, malloc, free, pthread_mutex_lock and file I/O calls made
+    from code linked into the plugin binary are intercepted as well. Enabling this replaces the global
+    operator new and delete, so never ship a release build with it.
+*/
+#ifndef JB_ENABLE_REALTIME_CHECKS
+#define JB_ENABLE_REALTIME_CHECKS 0
+#endif
+
+/** Config: JB_ENABLE_TRACING
+    Enables the JB_TRACE_SCOPE macro, which records scopes into per thread buffers that can be written to a Chrome trace
+    file via jb::Tracing::writeChromeTrace. The audio processing, preset, settings and editor code of this module is
+    instrumented with it. When disabled, the macro compiles to nothing.
+*/
+#ifndef JB_ENABLE_TRACING
+#define JB_ENABLE_TRACING 0
+#endif
+
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include <deque>
 #include <future>
 #include <thread>
 
@@ -74,13 +96,22 @@ JUCE_END_IGNORE_WARNINGS_GCC_LIKE
 
 #endif // JB_INCLUDE_JSON
 
+#include "DSP/Crossfade.h"
 #include "DSP/DelayLine.h"
+#include "DSP/FractionalDelayLine.h"
+#include "DSP/MultiTapDelayLine.h"
 
 #include "Presets/PresetManager.h"
 #include "Presets/SettingsManager.h"
 
 #include "Utils/Memory.h"
 #include "Utils/MessageOfTheDay.h"
+#include "Utils/ProcessLoadMeter.h"
+#include "Utils/RealtimeChecks.h"
+#include "Utils/SharedExecutor.h"
+#include "Utils/Tracing.h"
+
+#include "Parameters/ParameterList.h"
 
 JUCE_BEGIN_IGNORE_WARNINGS_GCC_LIKE("-Woverloaded-virtual")
 #include "Processor/PluginAudioProcessorBase.h"